@@ -0,0 +1,152 @@
+//! Benchmark of the queue of the jobs of the workers.
+//!
+//! One producer pushes small jobs to 1 to 64 consumers, like the server pushing
+//! the requests to its workers, through:
+//!
+//! - the previous queue: a [`mpsc`] channel whose receiver is guarded by a
+//! [`Mutex`], held by a worker during its wait;
+//! - the [`BoundedQueue`] of the workers.
+//!
+//! The producer yields while the bounded queue is full.
+//!
+//! # How to run it?
+//!
+//! ```shell
+//! cargo bench --bench queue
+//! ```
+
+use std::hint::black_box;
+use std::num::NonZeroUsize;
+use std::sync::mpsc;
+use std::sync::{Arc, Mutex};
+use std::thread;
+use std::time::{Duration, Instant};
+
+use self::queue::{BoundedQueue, PushError};
+
+/// The queue of the server, compiled alone.
+#[allow(dead_code, unused_imports)]
+#[path = "../src/threads/queue.rs"]
+mod queue;
+
+/// The amount of jobs pushed by each measure.
+const JOBS: u64 = 200_000;
+
+/// The capacity of the [`BoundedQueue`], like the one of the workers.
+const CAPACITY: usize = 1024;
+
+/// The amount of measures of each case, the median is kept.
+const MEASURES: usize = 5;
+
+/// The amounts of consumers.
+const CONSUMERS: [usize; 7] = [1, 2, 4, 8, 16, 32, 64];
+
+fn main() {
+    println!("consumers  mutex-channel  bounded-queue");
+
+    for consumers in CONSUMERS {
+        let channel = median(|| channel(consumers));
+        let bounded = median(|| bounded(consumers));
+
+        println!(
+            "{consumers:>9}  {:>10.1} ms  {:>10.1} ms",
+            channel.as_secs_f64() * 1000.0,
+            bounded.as_secs_f64() * 1000.0,
+        );
+    }
+}
+
+/// Measure the `case` [`MEASURES`] times.
+///
+/// # Returns
+///
+/// Returns the median duration.
+fn median(case: impl Fn() -> Duration) -> Duration {
+    let mut durations: Vec<Duration> = (0..MEASURES).map(|_| case()).collect();
+    durations.sort();
+
+    durations[MEASURES / 2]
+}
+
+/// The work of a job, a few hundreds of nanoseconds.
+fn work(job: u64) {
+    let mut value = job;
+    for _ in 0..64 {
+        value = black_box(
+            value
+                .wrapping_mul(6_364_136_223_846_793_005)
+                .wrapping_add(1),
+        );
+    }
+}
+
+/// Push the jobs through the mutex-guarded channel to the `consumers`.
+///
+/// # Returns
+///
+/// Returns the duration until all jobs are done.
+fn channel(consumers: usize) -> Duration {
+    let (sender, receiver) = mpsc::channel::<u64>();
+    let receiver = Arc::new(Mutex::new(receiver));
+
+    let start = Instant::now();
+    let handles: Vec<_> = (0..consumers)
+        .map(|_| {
+            let receiver = Arc::clone(&receiver);
+            thread::spawn(move || loop {
+                let job = receiver.lock().unwrap().recv();
+                match job {
+                    Ok(job) => work(job),
+                    Err(_) => break,
+                }
+            })
+        })
+        .collect();
+
+    for job in 0..JOBS {
+        sender.send(job).unwrap();
+    }
+    drop(sender);
+
+    for handle in handles {
+        handle.join().unwrap();
+    }
+    start.elapsed()
+}
+
+/// Push the jobs through the [`BoundedQueue`] to the `consumers`.
+///
+/// # Returns
+///
+/// Returns the duration until all jobs are done.
+fn bounded(consumers: usize) -> Duration {
+    let queue = Arc::new(BoundedQueue::<u64>::new(
+        NonZeroUsize::new(CAPACITY).unwrap(),
+    ));
+
+    let start = Instant::now();
+    let handles: Vec<_> = (0..consumers)
+        .map(|_| {
+            let queue = Arc::clone(&queue);
+            thread::spawn(move || {
+                while let Some(job) = queue.pop_wait(None, None) {
+                    work(job);
+                }
+            })
+        })
+        .collect();
+
+    for job in 0..JOBS {
+        let mut job = job;
+        while let Err(PushError::Full(rejected)) = queue.push(job) {
+            job = rejected;
+            thread::yield_now();
+        }
+    }
+    queue.close();
+
+    for handle in handles {
+        handle.join().unwrap();
+    }
+    start.elapsed()
+}
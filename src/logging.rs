@@ -0,0 +1,92 @@
+//! Module giving the asynchronous structured logging of the server.
+//!
+//! Each thread formats its records into its own lock-free ring, and the thread
+//! `Logger` writes the records of all threads on the standard output by batches.
+//! So, the workers never take the lock of the standard output.
+//!
+//! # How to use it?
+//!
+//! ```rust
+//! use crate::logging::{debug, flush, info};
+//!
+//! let id = 0;
+//!
+//! info!("Server started.");
+//!
+//! // The named values are written after the message, like `worker=0`.
+//! debug!(worker = id; "Worker got a job.");
+//!
+//! // Before the end of the process.
+//! flush();
+//! ```
+//!
+//! The levels greater than [`MAX_LEVEL`](level::MAX_LEVEL) are removed at compile
+//! time, with the formatting of their records.
+
+pub use self::level::{enabled, Level};
+pub use self::writer::{flush, write};
+
+/// Module contains the [`Level`] of the records.
+mod level;
+
+/// Module contains the [`Ring`](ring::Ring) of records of each thread.
+mod ring;
+
+/// Module contains the registry of the rings and the background writer.
+mod writer;
+
+/// Log a record of the level, if the level is compiled.
+///
+/// The named values are given before the message, and separated by `;`.
+///
+/// # Examples
+///
+/// ```rust
+/// use crate::logging::{log, Level};
+///
+/// log!(Level::Info, "Server started.");
+/// log!(Level::Info, port = 8000; "Server started on {}.", "127.0.0.1");
+/// ```
+macro_rules! log {
+    ($level:expr, $($key:ident = $value:expr),+ ; $($arg:tt)+) => {
+        if const { $crate::logging::enabled($level) } {
+            $crate::logging::write(
+                $level,
+                format_args!($($arg)+),
+                &[$((stringify!($key), &$value as &dyn ::std::fmt::Display)),+],
+            );
+        }
+    };
+    ($level:expr, $($arg:tt)+) => {
+        if const { $crate::logging::enabled($level) } {
+            $crate::logging::write($level, format_args!($($arg)+), &[]);
+        }
+    };
+}
+
+/// Log a record of the level [`Level::Error`], cf.[`log!`].
+macro_rules! error {
+    ($($arg:tt)+) => { $crate::logging::log!($crate::logging::Level::Error, $($arg)+) };
+}
+
+/// Log a record of the level [`Level::Warn`], cf.[`log!`].
+macro_rules! warning {
+    ($($arg:tt)+) => { $crate::logging::log!($crate::logging::Level::Warn, $($arg)+) };
+}
+
+/// Log a record of the level [`Level::Info`], cf.[`log!`].
+macro_rules! info {
+    ($($arg:tt)+) => { $crate::logging::log!($crate::logging::Level::Info, $($arg)+) };
+}
+
+/// Log a record of the level [`Level::Debug`], cf.[`log!`].
+macro_rules! debug {
+    ($($arg:tt)+) => { $crate::logging::log!($crate::logging::Level::Debug, $($arg)+) };
+}
+
+/// Log a record of the level [`Level::Trace`], cf.[`log!`].
+macro_rules! trace {
+    ($($arg:tt)+) => { $crate::logging::log!($crate::logging::Level::Trace, $($arg)+) };
+}
+
+pub(crate) use {debug, error, info, log, trace, warning};
@@ -0,0 +1,73 @@
+use std::fmt::{Display, Formatter};
+
+/// The severity of a log record.
+///
+/// The records of a level greater than [`MAX_LEVEL`] are removed at compile time,
+/// with their formatting.
+///
+/// # How to use it?
+///
+/// ```rust
+/// use crate::logging::{enabled, Level};
+///
+/// if enabled(Level::Debug) {
+///     // Only compiled in debug builds.
+/// }
+/// ```
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Hash)]
+pub enum Level {
+    /// An operation failed, and the server recovered from it.
+    Error,
+
+    /// An operation is degraded, like a rejected request.
+    Warn,
+
+    /// A change of the state of the server.
+    Info,
+
+    /// The details to debug the server.
+    Debug,
+
+    /// The details of each request, too many for a loaded server.
+    Trace,
+}
+
+impl Level {
+    /// Get the name of the level in lowercase.
+    pub const fn as_str(&self) -> &'static str {
+        match self {
+            Self::Error => "error",
+            Self::Warn => "warn",
+            Self::Info => "info",
+            Self::Debug => "debug",
+            Self::Trace => "trace",
+        }
+    }
+}
+
+impl Display for Level {
+    fn fmt(&self, f: &mut Formatter<'_>) -> std::fmt::Result {
+        f.write_str(self.as_str())
+    }
+}
+
+/// The greatest level compiled in the executable.
+///
+/// - [`Level::Trace`] with the feature `trace-logs`.
+/// - [`Level::Debug`] in debug builds.
+/// - [`Level::Info`] in release builds.
+pub const MAX_LEVEL: Level = if cfg!(feature = "trace-logs") {
+    Level::Trace
+} else if cfg!(debug_assertions) {
+    Level::Debug
+} else {
+    Level::Info
+};
+
+/// Indicate if the records of the `level` are compiled.
+///
+/// The function is evaluated at compile time in the logging macros, so the
+/// disabled records cost nothing.
+pub const fn enabled(level: Level) -> bool {
+    level as u8 <= MAX_LEVEL as u8
+}
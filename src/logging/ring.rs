@@ -0,0 +1,152 @@
+use std::cell::UnsafeCell;
+use std::sync::atomic::{AtomicUsize, Ordering};
+
+/// A lock-free ring of bytes, with one producer and one consumer.
+///
+/// Each thread writes its log records into its own ring, so the threads never
+/// compete on the standard output. The background writer drains the rings.
+///
+/// A record is pushed entirely or dropped, so the lines are never torn. If the
+/// ring is full, the record is dropped and counted, the producer never waits.
+///
+/// # How to use it?
+///
+/// ```rust
+/// use crate::logging::ring::Ring;
+///
+/// let ring = Ring::new(64);
+///
+/// assert!(ring.push(b"level=info msg=\"started\"\n"));
+///
+/// let mut batch = Vec::new();
+/// ring.drain_into(&mut batch);
+/// assert_eq!(batch, b"level=info msg=\"started\"\n");
+/// ```
+#[derive(Debug)]
+pub struct Ring {
+    #[doc(hidden)]
+    buffer: Box<[UnsafeCell<u8>]>,
+    #[doc(hidden)]
+    head: AtomicUsize,
+    #[doc(hidden)]
+    tail: AtomicUsize,
+    #[doc(hidden)]
+    dropped: AtomicUsize,
+}
+
+// SAFETY: The producer only writes the bytes between `head` and `tail +
+// capacity`, and the consumer only reads the bytes between `tail` and `head`.
+// The bytes are published with the release stores of the positions.
+unsafe impl Sync for Ring {}
+
+impl Ring {
+    /// Create a ring of `capacity` bytes.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Ring`].
+    pub fn new(capacity: usize) -> Ring {
+        Self {
+            buffer: (0..capacity).map(|_| UnsafeCell::new(0)).collect(),
+            head: AtomicUsize::new(0),
+            tail: AtomicUsize::new(0),
+            dropped: AtomicUsize::new(0),
+        }
+    }
+
+    /// Push the `record`, only called by the producer.
+    ///
+    /// # Returns
+    ///
+    /// Returns `false` if the ring is full, then the record is dropped.
+    pub fn push(&self, record: &[u8]) -> bool {
+        let head = self.head.load(Ordering::Relaxed);
+        let tail = self.tail.load(Ordering::Acquire);
+
+        if self.buffer.len() - (head - tail) < record.len() {
+            self.dropped.fetch_add(1, Ordering::Relaxed);
+            return false;
+        }
+
+        let start = head % self.buffer.len();
+        let first = record.len().min(self.buffer.len() - start);
+
+        // SAFETY: The free bytes are owned by the producer until the store of
+        // `head`, and the two copies stay in the buffer.
+        unsafe {
+            self.copy_in(start, &record[..first]);
+            self.copy_in(0, &record[first..]);
+        }
+
+        self.head.store(head + record.len(), Ordering::Release);
+        true
+    }
+
+    /// Move the pushed records at the end of the `batch`, only called by the
+    /// consumer.
+    pub fn drain_into(&self, batch: &mut Vec<u8>) {
+        let tail = self.tail.load(Ordering::Relaxed);
+        let head = self.head.load(Ordering::Acquire);
+
+        if head == tail {
+            return;
+        }
+
+        let start = tail % self.buffer.len();
+        let length = head - tail;
+        let first = length.min(self.buffer.len() - start);
+
+        // SAFETY: The bytes between `tail` and `head` are published by the
+        // producer, and are not overwritten until the store of `tail`.
+        unsafe {
+            self.copy_out(start, first, batch);
+            self.copy_out(0, length - first, batch);
+        }
+
+        self.tail.store(head, Ordering::Release);
+    }
+
+    /// Indicate if more than the half of the ring is used.
+    pub fn is_half_full(&self) -> bool {
+        let head = self.head.load(Ordering::Relaxed);
+        let tail = self.tail.load(Ordering::Relaxed);
+
+        (head - tail) * 2 > self.buffer.len()
+    }
+
+    /// Get and reset the amount of dropped records.
+    pub fn take_dropped(&self) -> usize {
+        self.dropped.swap(0, Ordering::Relaxed)
+    }
+
+    /// Copy the `bytes` into the buffer from the index `start`.
+    ///
+    /// # Safety
+    ///
+    /// The bytes must fit in the buffer, and must not be read by the consumer.
+    #[doc(hidden)]
+    unsafe fn copy_in(&self, start: usize, bytes: &[u8]) {
+        std::ptr::copy_nonoverlapping(
+            bytes.as_ptr(),
+            UnsafeCell::raw_get(self.buffer.as_ptr().add(start)),
+            bytes.len(),
+        );
+    }
+
+    /// Copy `length` bytes of the buffer from the index `start` at the end of the
+    /// `batch`.
+    ///
+    /// # Safety
+    ///
+    /// The bytes must be in the buffer, and must not be written by the producer.
+    #[doc(hidden)]
+    unsafe fn copy_out(&self, start: usize, length: usize, batch: &mut Vec<u8>) {
+        batch.reserve(length);
+        std::ptr::copy_nonoverlapping(
+            UnsafeCell::raw_get(self.buffer.as_ptr().add(start)),
+            batch.as_mut_ptr().add(batch.len()),
+            length,
+        );
+        batch.set_len(batch.len() + length);
+    }
+}
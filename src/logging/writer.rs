@@ -0,0 +1,190 @@
+use std::cell::RefCell;
+use std::fmt::{Arguments, Display, Write as _};
+use std::io::Write as _;
+use std::sync::{Arc, Mutex, OnceLock};
+use std::thread::{current, park_timeout, Builder, Thread};
+use std::time::Duration;
+
+use crate::requests::HttpDate;
+
+use super::level::Level;
+use super::ring::Ring;
+
+/// The capacity in bytes of the ring of each thread.
+const RING_CAPACITY: usize = 64 * 1024;
+
+/// The maximal delay between a record and its write on the standard output.
+const FLUSH_INTERVAL: Duration = Duration::from_millis(10);
+
+/// The rings of all threads which logged a record.
+static RINGS: Mutex<Vec<Arc<Ring>>> = Mutex::new(Vec::new());
+
+/// The batch of records written at once on the standard output. Its lock makes
+/// the drain of the rings exclusive.
+static BATCH: Mutex<Vec<u8>> = Mutex::new(Vec::new());
+
+/// The background thread `Logger`, which drains the rings.
+static WRITER: OnceLock<Thread> = OnceLock::new();
+
+thread_local! {
+    /// The ring and the line buffer of the current thread.
+    static LOCAL: Local = Local::register();
+}
+
+/// Format the record and push it into the ring of the current thread.
+///
+/// Use the macros [`error!`](super::error), [`warning!`](super::warning),
+/// [`info!`](super::info), [`debug!`](super::debug) or
+/// [`trace!`](super::trace), they remove the disabled levels at compile time.
+///
+/// The record is a line of `key=value` pairs, like:
+/// `time="Sun, 06 Nov 1994 08:49:37 GMT" level=info thread="Worker - 0" msg="got a job" worker=0`.
+///
+/// # Parameters
+///
+/// - `level`: The severity of the record.
+/// - `message`: The message of the record.
+/// - `fields`: The named values of the record.
+pub fn write(level: Level, message: Arguments<'_>, fields: &[(&str, &dyn Display)]) {
+    // The thread-local storage is destroyed at the end of the thread.
+    let _ = LOCAL.try_with(|local| local.write(level, message, fields));
+}
+
+/// Write all pushed records on the standard output, and wait for the write.
+///
+/// The background writer calls it periodically. Call it before the end of the
+/// process, so the last records are not lost.
+pub fn flush() {
+    let mut batch = BATCH.lock().expect("Cannot lock the batch of logs");
+
+    {
+        let mut rings = RINGS.lock().expect("Cannot lock the rings of logs");
+
+        for ring in rings.iter() {
+            ring.drain_into(&mut batch);
+
+            let dropped = ring.take_dropped();
+            if dropped > 0 {
+                let _ = writeln!(
+                    batch,
+                    "time=\"{}\" level={} msg=\"{dropped} records dropped, the ring is full\"",
+                    HttpDate::now(),
+                    Level::Warn,
+                );
+            }
+        }
+
+        // The ring of an ended thread is only owned by the registry.
+        rings.retain(|ring| Arc::strong_count(ring) > 1);
+    }
+
+    if !batch.is_empty() {
+        let _ = std::io::stdout().lock().write_all(&batch);
+        batch.clear();
+    }
+}
+
+/// The logging state of a thread.
+#[derive(Debug)]
+#[doc(hidden)]
+struct Local {
+    #[doc(hidden)]
+    ring: Arc<Ring>,
+    #[doc(hidden)]
+    thread: String,
+    #[doc(hidden)]
+    line: RefCell<String>,
+}
+
+impl Local {
+    /// Register the ring of the current thread, and start the background writer
+    /// with the first ring.
+    #[doc(hidden)]
+    fn register() -> Local {
+        let ring = Arc::new(Ring::new(RING_CAPACITY));
+        RINGS
+            .lock()
+            .expect("Cannot lock the rings of logs")
+            .push(Arc::clone(&ring));
+
+        WRITER.get_or_init(|| {
+            Builder::new()
+                .name(String::from("Logger"))
+                .spawn(|| loop {
+                    park_timeout(FLUSH_INTERVAL);
+                    flush();
+                })
+                .expect("Cannot spawn the logger thread.")
+                .thread()
+                .clone()
+        });
+
+        Self {
+            ring,
+            thread: current().name().unwrap_or("unnamed").to_string(),
+            line: RefCell::new(String::with_capacity(256)),
+        }
+    }
+
+    /// Format the record in the line buffer, and push it into the ring.
+    #[doc(hidden)]
+    fn write(&self, level: Level, message: Arguments<'_>, fields: &[(&str, &dyn Display)]) {
+        // A field which logs while it is formatted is ignored.
+        let Ok(mut line) = self.line.try_borrow_mut() else {
+            return;
+        };
+
+        line.clear();
+        let _ = write!(line, "time=\"{}\" level={level} thread=", HttpDate::now());
+        Self::write_value(&mut line, &self.thread);
+        line.push_str(" msg=");
+        Self::write_value(&mut line, &message);
+
+        for (key, value) in fields {
+            let _ = write!(line, " {key}=");
+            Self::write_value(&mut line, value);
+        }
+        line.push('\n');
+
+        self.ring.push(line.as_bytes());
+
+        if self.ring.is_half_full() {
+            if let Some(writer) = WRITER.get() {
+                writer.unpark();
+            }
+        }
+    }
+
+    /// Write the escaped `value` at the end of the `line`, quoted if it contains
+    /// a space.
+    #[doc(hidden)]
+    fn write_value(line: &mut String, value: &dyn Display) {
+        let start = line.len();
+        let _ = write!(Escape(line), "{value}");
+
+        if line[start..].is_empty() || line[start..].contains([' ', '=']) {
+            line.insert(start, '"');
+            line.push('"');
+        }
+    }
+}
+
+/// Writer escaping the quotes, the backslashes and the line breaks.
+#[doc(hidden)]
+struct Escape<'a>(&'a mut String);
+
+impl std::fmt::Write for Escape<'_> {
+    fn write_str(&mut self, s: &str) -> std::fmt::Result {
+        for character in s.chars() {
+            match character {
+                '"' => self.0.push_str("\\\""),
+                '\\' => self.0.push_str("\\\\"),
+                '\n' => self.0.push_str("\\n"),
+                '\r' => self.0.push_str("\\r"),
+                character => self.0.push(character),
+            }
+        }
+
+        Ok(())
+    }
+}
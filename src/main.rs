@@ -2,14 +2,31 @@
 
 #![doc(issue_tracker_base_url = "https://github.com/Xyphenore/web-server/issues/")]
 
-use std::num::NonZeroUsize;
+use std::env;
+use std::fmt::Display;
+use std::net::SocketAddr;
+use std::num::{NonZeroU32, NonZeroU64, NonZeroUsize};
+use std::str::FromStr;
+use std::time::Duration;
 
-use crate::routes::{index::get as get_index, slow_request::get as get_slow_request};
-use crate::server::{Debug, Method, WebServer};
+use crate::master::Master;
+use crate::routes::{
+    index::get as get_index, slow_request::get as get_blocking_request,
+    slow_request::get_async as get_slow_request, stream::get as get_stream,
+};
+use crate::server::{
+    Admission, Affinity, BusyPoll, Codel, Debug, Endpoint, KeepAlive, Lane, Method, Placement,
+    Scaling, Scheduler, Timeouts, WebServer,
+};
+use crate::threads::WorkerPool;
 
+mod logging;
+mod master;
+mod reactor;
 mod requests;
 mod routes;
 mod server;
+mod sockets;
 mod threads;
 
 #[doc(hidden)]
@@ -17,15 +34,351 @@ static DEBUG: bool = false;
 
 /// Executable script to start the Web server.
 ///
-/// Add [`routes::index::get()`] and [`routes::slow_request::get()`] to the server.
+/// Add [`routes::index::get()`], [`routes::slow_request::get_async()`],
+/// [`routes::slow_request::get()`] and [`routes::stream::get()`] to the server.
+/// The slow requests of `/slow_request` wait on the reactor without occupying any
+/// worker, those of `/slow_request/blocking` occupy a worker of the blocking pool,
+/// cf. [`Lane::Blocking`].
 /// The server listens on `127.0.0.1:8000`.
 ///
+/// # Settings
+///
+/// The server is configured with the environment variables:
+///
+/// - `WEB_SERVER_SCHEDULER`: The [`Scheduler`] of the workers, `shared` by
+/// default, `round-robin` or `least-loaded` for the work-stealing scheduler.
+/// - `WEB_SERVER_MIN_WORKERS`: The minimal amount of workers, the amount of
+/// usable CPUs by default, cf. [`Affinity::available_parallelism()`].
+/// - `WEB_SERVER_MAX_WORKERS`: The maximal amount of workers, 8 times the minimum
+/// by default, so the workers blocked on their clients do not starve the CPUs.
+/// - `WEB_SERVER_AFFINITY`: The [`Affinity`] of the workers, `floating` by
+/// default, or `pinned` to pin each worker to one CPU.
+/// - `WEB_SERVER_BLOCKING_WORKERS`: The amount of workers of the blocking pool,
+/// 8 by default.
+/// - `WEB_SERVER_BUSY_POLL`: The [`BusyPoll`] of the idle workers, `off` by
+/// default. For the latency-sensitive deployments, `adaptive` or the budget of
+/// the adaptive spin in microseconds, at the cost of spinning CPUs.
+/// - `WEB_SERVER_WAIT_THRESHOLD_MS`: The waiting time of the jobs, in milliseconds,
+/// above which the pool spawns a worker, cf. [`Scaling::with_wait_threshold()`].
+/// - `WEB_SERVER_IDLE_COOLDOWN_MS`: The idle time, in milliseconds, after which a
+/// worker retires, cf. [`Scaling::with_idle_cooldown()`].
+/// - `WEB_SERVER_HEADER_TIMEOUT_MS`, `WEB_SERVER_HANDLER_TIMEOUT_MS`,
+/// `WEB_SERVER_WRITE_TIMEOUT_MS` and `WEB_SERVER_DRAIN_TIMEOUT_MS`: The
+/// deadlines of the connections, in milliseconds, cf. [`Timeouts`].
+/// - `WEB_SERVER_HANDOFF`: The path of the control socket, to restart the
+/// server without refusing any connection, cf. [`WebServer::set_handoff()`].
+/// - `WEB_SERVER_ENDPOINTS`: The endpoints of the server, separated by commas,
+/// like `0.0.0.0:8080,unix:/run/web-server.sock`, `127.0.0.1:8000` by default,
+/// cf. [`WebServer::set_endpoints()`].
+/// - `WEB_SERVER_SOCKET_MODE`: The octal mode of the Unix domain sockets, cf.
+/// [`Endpoint::with_mode()`].
+/// - `WEB_SERVER_BACKLOG`: The length of the backlog of the endpoints, cf.
+/// [`Endpoint::with_backlog()`].
+/// - `WEB_SERVER_DEFER_ACCEPT_S`: The maximal wait of the first bytes of a TCP
+/// connection before its accept, in seconds, `0` to disable it, cf.
+/// [`Endpoint::with_defer_accept()`].
+/// - `WEB_SERVER_FAST_OPEN`: The queue of the TCP fast open, `0` to disable it,
+/// cf. [`Endpoint::with_fast_open()`].
+/// - `WEB_SERVER_KEEP_ALIVE`: `on` to probe the idle TCP connections, cf.
+/// [`KeepAlive::default()`].
+/// - `WEB_SERVER_SOCKET_BUSY_POLL_US`: The busy polling of the reads of the TCP
+/// connections, in microseconds, cf. [`Endpoint::with_busy_poll()`].
+/// - `WEB_SERVER_PROCESSES`: The amount of processes of the server, run by a
+/// [`Master`]. By default, the server runs in this process only. The handoff
+/// is not used with several processes, the master restarts them itself.
+/// - `WEB_SERVER_MEMORY_LIMIT_MB`: The resident memory, in mebibytes, above
+/// which the master recycles a process, cf. [`Master::with_memory_limit()`].
+///
 /// # Panics
 ///
 /// - If any method ([`WebServer::serve()`] or [`WebServer::add_listener()`]) panics.
+/// - If a setting is invalid.
 fn main() {
-    WebServer::new(NonZeroUsize::new(2).unwrap(), Debug::from(DEBUG))
+    match setting("WEB_SERVER_PROCESSES") {
+        Some(processes) => master(processes).run(server),
+        None => {
+            let mut server = server();
+            if let Some(path) = env::var_os("WEB_SERVER_HANDOFF") {
+                server.set_handoff(path);
+            }
+
+            server.serve();
+        }
+    }
+
+    logging::flush();
+}
+
+/// Create the server with its routes and its workers, from the settings.
+///
+/// # Returns
+///
+/// Returns the [`WebServer`], without handoff.
+///
+/// # Panics
+///
+/// - If a setting is invalid.
+#[doc(hidden)]
+fn server() -> WebServer {
+    let workers = WorkerPool::builder(scaling())
+        .scheduler(scheduler())
+        .affinity(affinity())
+        .admission(Admission::default().with_codel(Codel::default()))
+        .busy_poll(busy_poll())
+        .build();
+
+    let mut server = WebServer::with_pool(workers, Debug::from(DEBUG));
+    server
         .add_listener(Method::get("/").unwrap(), get_index)
-        .add_listener(Method::get("/slow_request").unwrap(), get_slow_request)
-        .serve();
+        .add_async_listener(Method::get("/slow_request").unwrap(), get_slow_request)
+        .add_listener(Method::get("/stream").unwrap(), get_stream)
+        .add_listener_on(
+            Method::get("/slow_request/blocking").unwrap(),
+            get_blocking_request,
+            Lane::Blocking,
+        )
+        .set_blocking_pool(WorkerPool::new(
+            setting("WEB_SERVER_BLOCKING_WORKERS").unwrap_or(NonZeroUsize::new(8).unwrap()),
+        ))
+        .set_timeouts(timeouts())
+        .set_endpoints(endpoints());
+
+    server
+}
+
+/// Create the [`Master`] of the `processes`, with the `WEB_SERVER_MEMORY_LIMIT_MB`
+/// setting.
+///
+/// # Returns
+///
+/// Returns the [`Master`].
+///
+/// # Panics
+///
+/// - If the memory limit is zero, or not a number of mebibytes.
+#[doc(hidden)]
+fn master(processes: NonZeroUsize) -> Master {
+    let master = Master::new(processes).with_endpoints(endpoints());
+
+    match setting::<NonZeroU64>("WEB_SERVER_MEMORY_LIMIT_MB") {
+        Some(limit) => master.with_memory_limit(
+            limit
+                .checked_mul(NonZeroU64::new(1024 * 1024).unwrap())
+                .expect("Invalid WEB_SERVER_MEMORY_LIMIT_MB: too large"),
+        ),
+        None => master,
+    }
+}
+
+/// Read the `WEB_SERVER_ENDPOINTS` setting, with the tuning of the endpoints.
+///
+/// # Returns
+///
+/// Returns the [`Endpoint`]s of the server.
+///
+/// # Panics
+///
+/// - If an endpoint is neither a socket address nor `unix:` and a path.
+/// - If a tuning setting is invalid.
+#[doc(hidden)]
+fn endpoints() -> Vec<Endpoint> {
+    let addresses = env::var("WEB_SERVER_ENDPOINTS").unwrap_or(String::from("127.0.0.1:8000"));
+
+    addresses
+        .split(',')
+        .map(|address| {
+            let address = address.trim();
+            let endpoint = match address.strip_prefix("unix:") {
+                Some(path) => Endpoint::unix(path),
+                None => match address.parse::<SocketAddr>() {
+                    Ok(address) => Endpoint::tcp(address),
+                    Err(error) => panic!("Invalid WEB_SERVER_ENDPOINTS: '{address}', {error}"),
+                },
+            };
+
+            tune(endpoint)
+        })
+        .collect()
+}
+
+/// Apply the tuning settings to the `endpoint`.
+///
+/// # Returns
+///
+/// Returns the tuned [`Endpoint`].
+///
+/// # Panics
+///
+/// - If a tuning setting is invalid.
+#[doc(hidden)]
+fn tune(mut endpoint: Endpoint) -> Endpoint {
+    if let Ok(mode) = env::var("WEB_SERVER_SOCKET_MODE") {
+        match u32::from_str_radix(&mode, 8) {
+            Ok(mode) => endpoint = endpoint.with_mode(mode),
+            Err(error) => panic!("Invalid WEB_SERVER_SOCKET_MODE: '{mode}', {error}"),
+        }
+    }
+    if let Some(backlog) = setting("WEB_SERVER_BACKLOG") {
+        endpoint = endpoint.with_backlog(backlog);
+    }
+    endpoint = match setting("WEB_SERVER_DEFER_ACCEPT_S") {
+        Some(0) => endpoint.without_defer_accept(),
+        Some(seconds) => endpoint.with_defer_accept(Duration::from_secs(seconds)),
+        None => endpoint,
+    };
+    endpoint = match setting("WEB_SERVER_FAST_OPEN").map(NonZeroU32::new) {
+        Some(Some(queue)) => endpoint.with_fast_open(queue),
+        Some(None) => endpoint.without_fast_open(),
+        None => endpoint,
+    };
+    endpoint = match env::var("WEB_SERVER_KEEP_ALIVE").as_deref() {
+        Err(_) | Ok("off") => endpoint,
+        Ok("on") => endpoint.with_keep_alive(KeepAlive::default()),
+        Ok(other) => panic!("Invalid WEB_SERVER_KEEP_ALIVE: '{other}'"),
+    };
+    if let Some(micros) = setting("WEB_SERVER_SOCKET_BUSY_POLL_US") {
+        endpoint = endpoint.with_busy_poll(Duration::from_micros(micros));
+    }
+
+    endpoint
+}
+
+/// Read the `WEB_SERVER_SCHEDULER` setting.
+///
+/// # Returns
+///
+/// Returns the [`Scheduler`] of the workers.
+///
+/// # Panics
+///
+/// - If the setting is not a scheduler.
+#[doc(hidden)]
+fn scheduler() -> Scheduler {
+    match env::var("WEB_SERVER_SCHEDULER").as_deref() {
+        Err(_) | Ok("shared") => Scheduler::Shared,
+        Ok("round-robin") => Scheduler::WorkStealing(Placement::RoundRobin),
+        Ok("least-loaded") => Scheduler::WorkStealing(Placement::LeastLoaded),
+        Ok(other) => panic!("Invalid WEB_SERVER_SCHEDULER: '{other}'"),
+    }
+}
+
+/// Read the `WEB_SERVER_AFFINITY` setting.
+///
+/// # Returns
+///
+/// Returns the [`Affinity`] of the workers.
+///
+/// # Panics
+///
+/// - If the setting is not an affinity.
+#[doc(hidden)]
+fn affinity() -> Affinity {
+    match env::var("WEB_SERVER_AFFINITY").as_deref() {
+        Err(_) | Ok("floating") => Affinity::Floating,
+        Ok("pinned") => Affinity::Pinned,
+        Ok(other) => panic!("Invalid WEB_SERVER_AFFINITY: '{other}'"),
+    }
+}
+
+/// Read the `WEB_SERVER_BUSY_POLL` setting.
+///
+/// # Returns
+///
+/// Returns the [`BusyPoll`] of the idle workers.
+///
+/// # Panics
+///
+/// - If the setting is neither `adaptive`, `off`, nor a positive number of
+/// microseconds.
+#[doc(hidden)]
+fn busy_poll() -> BusyPoll {
+    match env::var("WEB_SERVER_BUSY_POLL").as_deref() {
+        Err(_) | Ok("off") => BusyPoll::Off,
+        Ok("adaptive") => BusyPoll::adaptive(),
+        Ok(budget) => match budget.parse::<NonZeroU64>() {
+            Ok(budget) => BusyPoll::Adaptive(Duration::from_micros(budget.get())),
+            Err(error) => panic!("Invalid WEB_SERVER_BUSY_POLL: '{budget}', {error}"),
+        },
+    }
+}
+
+/// Read the settings of the [`Scaling`] of the workers.
+///
+/// # Returns
+///
+/// Returns the [`Scaling`] of the workers.
+///
+/// # Panics
+///
+/// - If an amount of workers is zero or not a number.
+/// - If the minimal amount of workers is greater than the maximum.
+/// - If a setting is not a number of milliseconds.
+#[doc(hidden)]
+fn scaling() -> Scaling {
+    let min = setting("WEB_SERVER_MIN_WORKERS").unwrap_or_else(Affinity::available_parallelism);
+    let max = setting("WEB_SERVER_MAX_WORKERS")
+        .unwrap_or_else(|| min.saturating_mul(NonZeroUsize::new(8).unwrap()));
+
+    let mut scaling = Scaling::new(min, max);
+
+    if let Some(threshold) = setting("WEB_SERVER_WAIT_THRESHOLD_MS") {
+        scaling = scaling.with_wait_threshold(Duration::from_millis(threshold));
+    }
+    if let Some(cooldown) = setting("WEB_SERVER_IDLE_COOLDOWN_MS") {
+        scaling = scaling.with_idle_cooldown(Duration::from_millis(cooldown));
+    }
+
+    scaling
+}
+
+/// Read the settings of the [`Timeouts`] of the connections.
+///
+/// # Returns
+///
+/// Returns the [`Timeouts`] of the connections.
+///
+/// # Panics
+///
+/// - If a setting is not a number of milliseconds, or is zero.
+#[doc(hidden)]
+fn timeouts() -> Timeouts {
+    let mut timeouts = Timeouts::default();
+
+    if let Some(header) = setting("WEB_SERVER_HEADER_TIMEOUT_MS") {
+        timeouts = timeouts.with_header(Duration::from_millis(header));
+    }
+    if let Some(handler) = setting("WEB_SERVER_HANDLER_TIMEOUT_MS") {
+        timeouts = timeouts.with_handler(Duration::from_millis(handler));
+    }
+    if let Some(write) = setting("WEB_SERVER_WRITE_TIMEOUT_MS") {
+        timeouts = timeouts.with_write(Duration::from_millis(write));
+    }
+    if let Some(drain) = setting("WEB_SERVER_DRAIN_TIMEOUT_MS") {
+        timeouts = timeouts.with_drain(Duration::from_millis(drain));
+    }
+
+    timeouts
+}
+
+/// Read the setting `name` and parse it.
+///
+/// # Returns
+///
+/// Returns the parsed value, or [`None`] if the setting is not set.
+///
+/// # Panics
+///
+/// - If the value cannot be parsed.
+#[doc(hidden)]
+fn setting<T>(name: &str) -> Option<T>
+where
+    T: FromStr,
+    T::Err: Display,
+{
+    let value = env::var(name).ok()?;
+
+    match value.parse() {
+        Ok(parsed) => Some(parsed),
+        Err(error) => panic!("Invalid {name}: '{value}', {error}"),
+    }
 }
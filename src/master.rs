@@ -0,0 +1,432 @@
+//! Module providing the [`Master`], running the server in several processes.
+//!
+//! To use it, go to the documentation of [`Master`].
+
+use std::env;
+use std::fs;
+use std::io;
+use std::net::{Ipv4Addr, SocketAddrV4};
+use std::num::{NonZeroU64, NonZeroUsize};
+use std::os::fd::{AsRawFd, FromRawFd, OwnedFd, RawFd};
+use std::os::unix::process::CommandExt;
+use std::process::{Child, Command};
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::Arc;
+use std::thread::sleep;
+use std::time::{Duration, Instant};
+
+use crate::logging::{info, warning};
+use crate::reactor::Reactor;
+use crate::server::WebServer;
+use crate::sockets::{self, Endpoint, Listener};
+
+/// The variable giving the listening sockets of the master to its processes, as
+/// descriptors separated by commas.
+#[doc(hidden)]
+const LISTENER_VARIABLE: &str = "WEB_SERVER_LISTENER";
+
+/// The master of the pre-forked processes of the server.
+///
+/// The master binds the listening socket, then starts the processes sharing
+/// it. Each process runs its own [`WebServer`], with its own workers, so a
+/// crashing or leaking listener only takes down its process, and the processes
+/// do not share their heap. The kernel spreads the connections among the
+/// processes accepting on the socket.
+///
+/// The master restarts any process ending before the stop, after a delay if it
+/// ended right after its start. With a memory limit, it also recycles the
+/// processes whose resident memory exceeds it: they drain, then are replaced.
+///
+/// At `Ctrl+C`, the master asks its processes to drain, and waits them. If the
+/// master dies, its processes drain and end too.
+///
+/// The processes are the same executable, started again by the master, instead
+/// of copies of the master: the master already runs threads, like the one of
+/// the logger, which a copy would not have.
+///
+/// # How to use it?
+///
+/// ```rust
+/// use std::num::NonZeroUsize;
+///
+/// use crate::master::Master;
+/// use crate::server::{Debug, WebServer};
+/// use crate::requests::{Method, Status, Request, Response};
+///
+/// fn process(request: Request) -> Response {
+///     request.make_response_with_status(Status::OK)
+/// }
+///
+/// // Executed in each process, never in the master.
+/// fn server() -> WebServer {
+///     let mut server = WebServer::new(5, Debug::False);
+///     server.add_listener(Method::get("/"), process);
+///
+///     server
+/// }
+///
+/// Master::new(NonZeroUsize::new(4).unwrap())
+///     .with_memory_limit(NonZeroU64::new(512 * 1024 * 1024).unwrap())
+///     .run(server);
+/// ```
+#[derive(Debug)]
+pub struct Master {
+    #[doc(hidden)]
+    processes: NonZeroUsize,
+    #[doc(hidden)]
+    memory_limit: Option<NonZeroU64>,
+    #[doc(hidden)]
+    endpoints: Vec<Endpoint>,
+}
+
+impl Master {
+    /// The minimal lifetime of a process restarted at once. A process ending
+    /// before is restarted after [`Master::RESTART_DELAY`], to not loop on a
+    /// process crashing at its start.
+    pub const MIN_LIFETIME: Duration = Duration::from_secs(1);
+
+    /// The delay before the restart of a process ending right after its start.
+    pub const RESTART_DELAY: Duration = Duration::from_secs(1);
+
+    /// The maximal duration between two checks of the processes.
+    #[doc(hidden)]
+    const SUPERVISION_INTERVAL: Duration = Duration::from_millis(100);
+
+    /// Create the master of `processes` processes.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Master`], without memory limit, listening on
+    /// `127.0.0.1:8000`.
+    pub fn new(processes: NonZeroUsize) -> Master {
+        Self {
+            processes,
+            memory_limit: None,
+            endpoints: vec![Endpoint::tcp(SocketAddrV4::new(Ipv4Addr::LOCALHOST, 8000))],
+        }
+    }
+
+    /// Recycle the processes whose resident memory exceeds `bytes`.
+    ///
+    /// # Returns
+    ///
+    /// Returns the instance of [`Master`] with the memory limit.
+    pub fn with_memory_limit(mut self, bytes: NonZeroU64) -> Master {
+        self.memory_limit = Some(bytes);
+
+        self
+    }
+
+    /// Listen on the `endpoints`, instead of `127.0.0.1:8000`. All processes
+    /// accept on all endpoints.
+    ///
+    /// # Returns
+    ///
+    /// Returns the instance of [`Master`] with the endpoints.
+    ///
+    /// # Panics
+    ///
+    /// - If there is no endpoint, or more than [`Reactor::MAX_LISTENERS`].
+    pub fn with_endpoints(mut self, endpoints: impl IntoIterator<Item = Endpoint>) -> Master {
+        let endpoints: Vec<Endpoint> = endpoints.into_iter().collect();
+        assert!(
+            (1..=Reactor::MAX_LISTENERS).contains(&endpoints.len()),
+            "The master needs between 1 and {} endpoints",
+            Reactor::MAX_LISTENERS,
+        );
+        self.endpoints = endpoints;
+
+        self
+    }
+
+    /// Run the master, or the server if the current process is one of the
+    /// processes of the master.
+    ///
+    /// In the master, it returns once all processes ended. In a process, it
+    /// creates the server with `server` and serves on the listening sockets of
+    /// the master, cf.[`WebServer::serve_listeners()`].
+    ///
+    /// The listening sockets are inherited from the service manager, like with
+    /// the socket activation of `systemd`, else they are bound on the endpoints,
+    /// cf.[`Master::with_endpoints()`].
+    ///
+    /// # Panics
+    ///
+    /// - If it is not possible to bind an endpoint, cf.[`Endpoint::bind()`].
+    /// - If the service manager gives more than [`Reactor::MAX_LISTENERS`]
+    /// sockets.
+    /// - If the current executable cannot be found, or a process cannot be
+    /// started.
+    /// - If [`ctrlc::set_handler()`] fails.
+    /// - If the server panics, in a process, cf.[`WebServer::serve()`].
+    pub fn run(&self, server: impl FnOnce() -> WebServer) {
+        match env::var(LISTENER_VARIABLE) {
+            Ok(fds) => {
+                let listeners = fds
+                    .split(',')
+                    .map(|fd| {
+                        let fd = fd
+                            .parse::<RawFd>()
+                            .expect("Cannot read the listening sockets of the master.");
+                        // SAFETY: The master gives its listening sockets to this
+                        // process only, and the variable is read once.
+                        let listener = Listener::from(unsafe { OwnedFd::from_raw_fd(fd) });
+                        set_cloexec(listener.as_raw_fd(), true);
+
+                        listener
+                    })
+                    .collect();
+
+                server().serve_listeners(listeners);
+            }
+            Err(_) => self.supervise(),
+        }
+    }
+
+    /// Start the processes, and restart them until `Ctrl+C`.
+    ///
+    /// # Panics
+    ///
+    /// Same as [`Master::run()`].
+    #[doc(hidden)]
+    fn supervise(&self) {
+        let inherited = sockets::inherited();
+        let listeners: Vec<Listener> = if inherited.is_empty() {
+            self.endpoints
+                .iter()
+                .map(|endpoint| {
+                    endpoint.bind().unwrap_or_else(|error| {
+                        panic!("Cannot bind {}: {error}", endpoint.address())
+                    })
+                })
+                .collect()
+        } else {
+            info!(listeners = inherited.len(); "Listeners inherited from the service manager.");
+            assert!(
+                inherited.len() <= Reactor::MAX_LISTENERS,
+                "The master cannot serve more than {} listeners",
+                Reactor::MAX_LISTENERS,
+            );
+            inherited.into_iter().map(Listener::from).collect()
+        };
+
+        let is_running = Arc::new(AtomicBool::new(true));
+        let cloned_is_running = Arc::clone(&is_running);
+        ctrlc::set_handler(move || cloned_is_running.store(false, Ordering::Release))
+            .expect("Cannot set handler for ctrl+c");
+
+        let mut processes: Vec<Process> = (0..self.processes.get())
+            .map(|index| self.spawn(index, &listeners))
+            .collect();
+        for listener in &listeners {
+            info!(
+                address = listener.local_addr().unwrap(), processes = processes.len();
+                "Master started its processes.",
+            );
+        }
+
+        while is_running.load(Ordering::Acquire) {
+            for (index, process) in processes.iter_mut().enumerate() {
+                self.check(index, process, &listeners);
+            }
+
+            sleep(Self::SUPERVISION_INTERVAL);
+        }
+
+        info!("Master stopping its processes.");
+        for process in &mut processes {
+            if let Process::Running { child, .. } = process {
+                interrupt(child);
+            }
+        }
+        for process in &mut processes {
+            if let Process::Running { child, .. } = process {
+                // The process is already reaped if it cannot be waited.
+                let _ = child.wait();
+            }
+        }
+    }
+
+    /// Start the process `index`, serving on the `listeners`.
+    ///
+    /// # Returns
+    ///
+    /// Returns the started process.
+    ///
+    /// # Panics
+    ///
+    /// - If the current executable cannot be found, or the process cannot be
+    /// started.
+    #[doc(hidden)]
+    fn spawn(&self, index: usize, listeners: &[Listener]) -> Process {
+        let fds: Vec<RawFd> = listeners.iter().map(AsRawFd::as_raw_fd).collect();
+        let variable = fds
+            .iter()
+            .map(RawFd::to_string)
+            .collect::<Vec<_>>()
+            .join(",");
+        let master = std::process::id();
+
+        let mut command = Command::new(env::current_exe().expect("Cannot find the executable."));
+        command
+            .args(env::args_os().skip(1))
+            .env(LISTENER_VARIABLE, variable)
+            // The service manager gives the sockets to the master only.
+            .env_remove("LISTEN_PID")
+            .env_remove("LISTEN_FDS");
+
+        // SAFETY: Between the fork and the execution, only system calls safe
+        // after a fork are made, without allocation.
+        unsafe {
+            command.pre_exec(move || {
+                for &fd in &fds {
+                    if !set_cloexec(fd, false) {
+                        return Err(io::Error::last_os_error());
+                    }
+                }
+
+                #[cfg(target_os = "linux")]
+                if libc::prctl(libc::PR_SET_PDEATHSIG, libc::SIGINT) == -1 {
+                    return Err(io::Error::last_os_error());
+                }
+
+                // The master died before the registration of the signal.
+                match libc::getppid() as u32 == master {
+                    true => Ok(()),
+                    false => Err(io::ErrorKind::NotConnected.into()),
+                }
+            });
+        }
+
+        let child = command
+            .spawn()
+            .expect("Cannot start a process of the server.");
+        info!(process = index, pid = child.id(); "Process started.");
+
+        Process::Running {
+            child,
+            started: Instant::now(),
+            recycling: false,
+        }
+    }
+
+    /// Restart the `process` if it ended, or recycle it if its memory exceeds
+    /// the limit.
+    ///
+    /// # Panics
+    ///
+    /// Same as [`Master::spawn()`].
+    #[doc(hidden)]
+    fn check(&self, index: usize, process: &mut Process, listeners: &[Listener]) {
+        match process {
+            Process::Running {
+                child,
+                started,
+                recycling,
+            } => match child.try_wait() {
+                Ok(Some(status)) => {
+                    let restart_at = match *recycling || started.elapsed() >= Self::MIN_LIFETIME {
+                        true => Instant::now(),
+                        false => Instant::now() + Self::RESTART_DELAY,
+                    };
+                    if !*recycling {
+                        warning!(process = index, pid = child.id(), status = status; "Process ended; restarting it.");
+                    }
+
+                    *process = Process::Waiting { restart_at };
+                }
+                Ok(None) => {
+                    let (Some(limit), false) = (self.memory_limit, *recycling) else {
+                        return;
+                    };
+
+                    if let Some(resident) = resident_memory(child.id()) {
+                        if resident > limit.get() {
+                            warning!(
+                                process = index, pid = child.id(), resident = resident, limit = limit;
+                                "Process exceeds its memory limit; recycling it.",
+                            );
+                            interrupt(child);
+                            *recycling = true;
+                        }
+                    }
+                }
+                Err(error) => {
+                    warning!(process = index, error = error; "Process cannot be checked.")
+                }
+            },
+            Process::Waiting { restart_at } => {
+                if Instant::now() >= *restart_at {
+                    *process = self.spawn(index, listeners);
+                }
+            }
+        }
+    }
+}
+
+/// A process of the [`Master`].
+#[derive(Debug)]
+#[doc(hidden)]
+enum Process {
+    /// The process is running.
+    Running {
+        #[doc(hidden)]
+        child: Child,
+        #[doc(hidden)]
+        started: Instant,
+        /// Indicate if the process drains, because it exceeds the memory limit.
+        #[doc(hidden)]
+        recycling: bool,
+    },
+    /// The process ended, and waits its restart.
+    Waiting {
+        #[doc(hidden)]
+        restart_at: Instant,
+    },
+}
+
+/// Ask the `child` to drain and end.
+#[doc(hidden)]
+fn interrupt(child: &Child) {
+    // SAFETY: The process is not reaped yet, so its identifier is not reused.
+    unsafe { libc::kill(child.id() as libc::pid_t, libc::SIGINT) };
+}
+
+/// Get the resident memory of the process `pid`, in bytes.
+///
+/// # Returns
+///
+/// Returns the resident memory, or nothing if it cannot be read.
+#[doc(hidden)]
+fn resident_memory(pid: u32) -> Option<u64> {
+    let statm = fs::read_to_string(format!("/proc/{pid}/statm")).ok()?;
+    let pages: u64 = statm.split_whitespace().nth(1)?.parse().ok()?;
+
+    // SAFETY: The call only reads a configuration of the system.
+    let page_size = unsafe { libc::sysconf(libc::_SC_PAGESIZE) };
+
+    Some(pages * page_size as u64)
+}
+
+/// Mark the `fd` close-on-exec, or not.
+///
+/// It is safe to call after a fork.
+///
+/// # Returns
+///
+/// Returns `false` if the `fd` is not open.
+#[doc(hidden)]
+fn set_cloexec(fd: RawFd, cloexec: bool) -> bool {
+    // SAFETY: The command only reads the flags of the descriptor.
+    let flags = unsafe { libc::fcntl(fd, libc::F_GETFD) };
+    if flags == -1 {
+        return false;
+    }
+
+    let flags = match cloexec {
+        true => flags | libc::FD_CLOEXEC,
+        false => flags & !libc::FD_CLOEXEC,
+    };
+    // SAFETY: The command only changes the flags of the descriptor.
+    unsafe { libc::fcntl(fd, libc::F_SETFD, flags) != -1 }
+}
@@ -0,0 +1,61 @@
+//! Module giving the I/O [`Reactor`] of the server, and the executor of the
+//! asynchronous listeners.
+//!
+//! The reactor waits for the readiness of the sockets with `epoll` on Linux, and
+//! with `poll` on the other Unix systems. The asynchronous tasks are polled on
+//! the thread of the reactor when they are woken, so a waiting request costs one
+//! small task instead of one thread.
+//!
+//! The workers hand the responses over to the reactor with the [`Outbox`], so a
+//! client reading its response slowly does not keep a worker busy. Until then,
+//! the reactor watches the connection, and cancels the [`Cancellation`] of the
+//! request when the client hangs up.
+//!
+//! The timers of the reactor, like the deadlines of the connections, are in a
+//! hierarchical timer wheel, so thousands of connections cost `O(1)` per timer.
+//!
+//! To use it, go to the documentation of [`Reactor`], [`sleep()`],
+//! [`timeout()`] and [`Cancellation`].
+
+pub use self::cancellation::{cancellable, Cancellation};
+pub use self::event_loop::Reactor;
+pub use self::output::{Outbox, Segment};
+pub use self::ticket::Ticket;
+pub use self::timeouts::Timeouts;
+pub use self::timer::{sleep, timeout};
+
+/// Module contains the [`Cancellation`] of the requests, and [`cancellable()`].
+mod cancellation;
+
+/// Module contains the [`Connection`](connection::Connection) reading the head
+/// of a request.
+mod connection;
+
+/// Module contains the [`Reactor`].
+mod event_loop;
+
+/// Module contains the [`Executor`](executor::Executor) of the asynchronous
+/// tasks.
+mod executor;
+
+/// Module contains the [`Notifier`](notifier::Notifier) waking up the reactor.
+mod notifier;
+
+/// Module contains the [`Outbox`] and the bounded queues of the responses.
+mod output;
+
+/// Module contains the [`Poller`](poller::Poller) of the system.
+mod poller;
+
+/// Module contains the [`Ticket`] linking a request to its watched connection.
+mod ticket;
+
+/// Module contains the [`Timeouts`] of the connections.
+mod timeouts;
+
+/// Module contains the [`Timers`](timer::Timers) of the reactor, [`sleep()`] and
+/// [`timeout()`].
+mod timer;
+
+/// Module contains the [`TimerWheel`](wheel::TimerWheel).
+mod wheel;
@@ -0,0 +1,183 @@
+use std::future::Future;
+use std::pin::Pin;
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::{Arc, Mutex};
+use std::task::{Context, Poll, Waker};
+
+/// The signal that the client of a request closed its connection, so the work
+/// of its listener is useless.
+///
+/// The reactor watches the connection of each request read by it, and cancels
+/// its token when the client hangs up. A synchronous listener polls
+/// [`Cancellation::is_cancelled()`] between its steps, and an asynchronous one
+/// is dropped by the server, cf.[`cancellable()`].
+///
+/// A client half-closing its connection after its request, with
+/// `shutdown(SHUT_WR)`, is seen as gone.
+///
+/// # How to use it?
+///
+/// ```rust
+/// use std::thread::sleep;
+/// use std::time::Duration;
+///
+/// use crate::requests::{Request, Response, Status};
+///
+/// fn get(request: Request) -> Response {
+///     let cancellation = request.cancellation();
+///
+///     for _ in 0..50 {
+///         if cancellation.is_cancelled() {
+///             // The response is not sent, the client is gone.
+///             break;
+///         }
+///         sleep(Duration::from_millis(100));
+///     }
+///
+///     Response::from((request, Status::Ok))
+/// }
+/// ```
+#[derive(Debug, Clone, Default)]
+pub struct Cancellation {
+    #[doc(hidden)]
+    shared: Arc<Signal>,
+}
+
+impl Cancellation {
+    /// Indicate if the client closed the connection.
+    pub fn is_cancelled(&self) -> bool {
+        self.shared.cancelled.load(Ordering::Acquire)
+    }
+
+    /// Cancel the token, and wake up the tasks awaiting it.
+    ///
+    /// # Panics
+    ///
+    /// - If the lock is poisoned.
+    pub fn cancel(&self) {
+        self.shared.cancelled.store(true, Ordering::Release);
+
+        for waker in self.shared.lock().drain(..) {
+            waker.wake();
+        }
+    }
+
+    /// Wait the cancellation of the token, without blocking the thread.
+    ///
+    /// # Returns
+    ///
+    /// Returns the future ending when the token is cancelled.
+    pub fn cancelled(&self) -> Cancelled {
+        Cancelled {
+            cancellation: self.clone(),
+        }
+    }
+}
+
+/// The shared state of the [`Cancellation`].
+#[derive(Debug, Default)]
+#[doc(hidden)]
+struct Signal {
+    #[doc(hidden)]
+    cancelled: AtomicBool,
+    /// The tasks awaiting the cancellation.
+    #[doc(hidden)]
+    wakers: Mutex<Vec<Waker>>,
+}
+
+impl Signal {
+    /// Lock the tasks awaiting the cancellation.
+    ///
+    /// # Panics
+    ///
+    /// - If the lock is poisoned.
+    #[doc(hidden)]
+    fn lock(&self) -> std::sync::MutexGuard<'_, Vec<Waker>> {
+        self.wakers
+            .lock()
+            .expect("Cannot lock the wakers of the cancellation")
+    }
+}
+
+/// The future returned by [`Cancellation::cancelled()`].
+#[derive(Debug)]
+#[must_use = "A cancellation does nothing until it is awaited"]
+pub struct Cancelled {
+    #[doc(hidden)]
+    cancellation: Cancellation,
+}
+
+impl Future for Cancelled {
+    type Output = ();
+
+    /// # Panics
+    ///
+    /// - If the lock is poisoned.
+    fn poll(self: Pin<&mut Self>, context: &mut Context<'_>) -> Poll<Self::Output> {
+        if self.cancellation.is_cancelled() {
+            return Poll::Ready(());
+        }
+
+        let mut wakers = self.cancellation.shared.lock();
+        if !wakers.iter().any(|waker| waker.will_wake(context.waker())) {
+            wakers.push(context.waker().clone());
+        }
+        drop(wakers);
+
+        // The token can be cancelled before the registration of the waker.
+        match self.cancellation.is_cancelled() {
+            true => Poll::Ready(()),
+            false => Poll::Pending,
+        }
+    }
+}
+
+/// Wait the `future` until the `cancellation`, without blocking the thread.
+///
+/// If the token is cancelled first, the `future` is dropped with the task.
+///
+/// # Examples
+///
+/// ```rust
+/// use std::time::Duration;
+///
+/// use crate::reactor::{cancellable, sleep, Cancellation};
+///
+/// async fn slow(cancellation: Cancellation) {
+///     let slow = Box::pin(sleep(Duration::from_secs(5)));
+///
+///     if cancellable(cancellation, slow).await.is_none() {
+///         // The client is gone.
+///     }
+/// }
+/// ```
+pub fn cancellable<F: Future + Unpin>(cancellation: Cancellation, future: F) -> Cancellable<F> {
+    Cancellable {
+        future,
+        cancelled: cancellation.cancelled(),
+    }
+}
+
+/// The future returned by [`cancellable()`].
+///
+/// It returns the output of its future, or [`None`] if the token is cancelled.
+#[derive(Debug)]
+#[must_use = "A cancellable future does nothing until it is awaited"]
+pub struct Cancellable<F> {
+    #[doc(hidden)]
+    future: F,
+    #[doc(hidden)]
+    cancelled: Cancelled,
+}
+
+impl<F: Future + Unpin> Future for Cancellable<F> {
+    type Output = Option<F::Output>;
+
+    fn poll(mut self: Pin<&mut Self>, context: &mut Context<'_>) -> Poll<Self::Output> {
+        if let Poll::Ready(()) = Pin::new(&mut self.cancelled).poll(context) {
+            return Poll::Ready(None);
+        }
+
+        Pin::new(&mut self.future).poll(context).map(Some)
+    }
+}
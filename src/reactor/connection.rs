@@ -0,0 +1,116 @@
+use super::wheel::TimerId;
+use crate::sockets::Stream;
+use std::io::{ErrorKind, Read};
+
+/// A connection accepted by the reactor, until the head of its request is read.
+///
+/// The stream is in non-blocking mode, so a slow client does not block the
+/// reactor. The timer closes the connection if the head is not read before its
+/// deadline.
+#[derive(Debug)]
+pub struct Connection {
+    #[doc(hidden)]
+    stream: Stream,
+    #[doc(hidden)]
+    head: Vec<u8>,
+    #[doc(hidden)]
+    timer: TimerId,
+}
+
+impl Connection {
+    /// The maximal size of the head of a request.
+    pub const MAX_HEAD_SIZE: usize = 8 * 1024;
+
+    /// The end of the head of a request.
+    #[doc(hidden)]
+    const HEAD_END: &'static [u8] = b"\r\n\r\n";
+
+    /// Create the connection of the `stream`, closed at the expiration of the
+    /// `timer`.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Connection`].
+    pub fn new(stream: Stream, timer: TimerId) -> Connection {
+        Self {
+            stream,
+            head: Vec::new(),
+            timer,
+        }
+    }
+
+    /// Get the timer of the deadline of the head.
+    pub fn timer(&self) -> TimerId {
+        self.timer
+    }
+
+    /// Read the available bytes of the head, until the stream would block.
+    ///
+    /// # Returns
+    ///
+    /// Returns the [`Progress`] of the read.
+    pub fn read_head(&mut self) -> Progress {
+        let mut buffer = [0; 1024];
+
+        loop {
+            match self.stream.read(&mut buffer) {
+                Ok(0) => return Progress::Closed,
+                Ok(read) => {
+                    // The end can overlap the previous bytes.
+                    let from = self.head.len().saturating_sub(Self::HEAD_END.len() - 1);
+                    self.head.extend_from_slice(&buffer[..read]);
+
+                    if let Some(end) = self.head[from..]
+                        .windows(Self::HEAD_END.len())
+                        .position(|window| window == Self::HEAD_END)
+                    {
+                        self.head.truncate(from + end);
+                        return Progress::Complete;
+                    }
+                    if self.head.len() > Self::MAX_HEAD_SIZE {
+                        return Progress::TooLarge;
+                    }
+                }
+                Err(error) if error.kind() == ErrorKind::WouldBlock => return Progress::Pending,
+                Err(error) if error.kind() == ErrorKind::Interrupted => {}
+                Err(_) => return Progress::Closed,
+            }
+        }
+    }
+
+    /// Get the head and the stream of the connection, after a
+    /// [`Progress::Complete`].
+    ///
+    /// # Returns
+    ///
+    /// Returns the head as text, lossy if it is not valid UTF-8, and the stream.
+    pub fn into_head(self) -> (String, Stream) {
+        let head = match String::from_utf8(self.head) {
+            Ok(head) => head,
+            Err(error) => String::from_utf8_lossy(error.as_bytes()).into_owned(),
+        };
+
+        (head, self.stream)
+    }
+
+    /// Get the stream of the connection, dropping the read bytes.
+    pub fn into_stream(self) -> Stream {
+        self.stream
+    }
+}
+
+/// The state of the head of a [`Connection`], after [`Connection::read_head()`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Progress {
+    /// The head is incomplete, the stream would block.
+    Pending,
+
+    /// The head is complete, until its empty line.
+    Complete,
+
+    /// The client closed the connection, or the connection is in error.
+    Closed,
+
+    /// The head is larger than [`Connection::MAX_HEAD_SIZE`].
+    TooLarge,
+}
@@ -0,0 +1,624 @@
+use std::error::Error;
+use std::future::Future;
+use std::io::{self, ErrorKind, Read};
+use std::os::unix::net::UnixStream;
+use std::sync::Arc;
+use std::time::{Duration, Instant};
+
+use super::cancellation::Cancellation;
+use super::connection::{Connection, Progress};
+use super::executor::Executor;
+use super::notifier::Notifier;
+use super::output::{Flush, Outbox, Output};
+use super::poller::{Event, Interest, Poller};
+use super::ticket::Ticket;
+use super::timer::{Expiry, Timers};
+use super::wheel::TimerId;
+use super::Timeouts;
+use crate::logging::{debug, warning};
+use crate::requests::{Request, Response};
+use crate::sockets::{Listener, Stream};
+
+/// The I/O reactor of the server: it accepts the connections of its listeners,
+/// TCP or Unix domain, reads the heads
+/// of their requests, writes their responses, fires the timers and executes the
+/// asynchronous tasks, on one thread.
+///
+/// The heads are read and the responses are written without blocking, so a
+/// client sending its request or reading its response slowly costs only its
+/// buffers. A connection whose head is not complete before the deadline of its
+/// [`Timeouts`], or whose response does not progress before it, is closed.
+///
+/// While its listener runs, the connection is watched for the hang-up of the
+/// client, which cancels the [`Cancellation`] of its request.
+///
+/// # How to use it?
+///
+/// ```rust
+/// // Logic in the server in `src/server.rs`.
+///
+/// use std::net::{Ipv4Addr, SocketAddrV4};
+/// use std::time::Duration;
+///
+/// use crate::reactor::{sleep, Reactor, Timeouts};
+/// use crate::sockets::Endpoint;
+///
+/// let listeners = vec![
+///     Endpoint::tcp(SocketAddrV4::new(Ipv4Addr::LOCALHOST, 8000)).bind().unwrap(),
+///     Endpoint::unix("/run/web-server/http.sock").bind().unwrap(),
+/// ];
+/// let mut reactor = Reactor::new(listeners, Timeouts::default()).unwrap();
+///
+/// reactor.spawn(async {
+///     sleep(Duration::from_secs(1)).await;
+///     println!("One second later.");
+/// });
+///
+/// let mut requests = Vec::new();
+/// loop {
+///     reactor.turn(Duration::from_millis(100), &mut requests).unwrap();
+///
+///     for request in requests.drain(..) {
+///         // Process the request, its response is written by the reactor.
+///     }
+/// }
+/// ```
+#[derive(Debug)]
+pub struct Reactor {
+    #[doc(hidden)]
+    poller: Poller,
+    /// The listeners, none once the reactor stopped accepting.
+    #[doc(hidden)]
+    listeners: Vec<Listener>,
+    #[doc(hidden)]
+    notifications: UnixStream,
+    #[doc(hidden)]
+    notifier: Arc<Notifier>,
+    #[doc(hidden)]
+    executor: Executor,
+    #[doc(hidden)]
+    outbox: Outbox,
+    #[doc(hidden)]
+    events: Vec<Event>,
+    #[doc(hidden)]
+    connections: Vec<Option<Slot>>,
+    #[doc(hidden)]
+    free: Vec<usize>,
+    /// The connections waiting the next bytes of their streamed response.
+    #[doc(hidden)]
+    waiting: Vec<u64>,
+    /// The listeners whose accept failed, accepted again at the next turn.
+    #[doc(hidden)]
+    backlogged: Vec<usize>,
+    #[doc(hidden)]
+    expired: Vec<u64>,
+    #[doc(hidden)]
+    released: Vec<u64>,
+    #[doc(hidden)]
+    outputs: Vec<Output>,
+    #[doc(hidden)]
+    timeouts: Timeouts,
+}
+
+impl Reactor {
+    /// The maximal amount of listeners.
+    pub const MAX_LISTENERS: usize = 16;
+
+    /// The token of the notifications of the woken tasks and of the handed over
+    /// responses in the poller.
+    #[doc(hidden)]
+    const NOTIFICATIONS: u64 = 0;
+
+    /// The token of the first listener in the poller, the next ones follow.
+    #[doc(hidden)]
+    const FIRST_LISTENER: u64 = 1;
+
+    /// The token of the first connection in the poller, the next ones follow.
+    #[doc(hidden)]
+    const FIRST_CONNECTION: u64 = Self::FIRST_LISTENER + Self::MAX_LISTENERS as u64;
+
+    /// Create the reactor of the `listeners`, on the current thread.
+    ///
+    /// # Parameters
+    ///
+    /// - `listeners`: The listeners of the connections.
+    /// - `timeouts`: The deadlines of the connections.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Reactor`], or the error of the system.
+    ///
+    /// # Panics
+    ///
+    /// - If there is no listener, or more than [`Reactor::MAX_LISTENERS`].
+    pub fn new(listeners: Vec<Listener>, timeouts: Timeouts) -> io::Result<Reactor> {
+        assert!(
+            (1..=Self::MAX_LISTENERS).contains(&listeners.len()),
+            "The reactor needs between 1 and {} listeners",
+            Self::MAX_LISTENERS,
+        );
+        let mut poller = Poller::new()?;
+
+        for (index, listener) in listeners.iter().enumerate() {
+            listener.set_nonblocking(true)?;
+            poller.register(
+                listener,
+                Self::FIRST_LISTENER + index as u64,
+                Interest::Read,
+            )?;
+        }
+
+        let (sender, notifications) = UnixStream::pair()?;
+        sender.set_nonblocking(true)?;
+        notifications.set_nonblocking(true)?;
+        poller.register(&notifications, Self::NOTIFICATIONS, Interest::Read)?;
+        let notifier = Arc::new(Notifier::new(sender));
+
+        Timers::drive_current_thread();
+
+        Ok(Self {
+            poller,
+            listeners,
+            notifications,
+            executor: Executor::new(Arc::clone(&notifier)),
+            outbox: Outbox::new(Arc::clone(&notifier)),
+            notifier,
+            events: Vec::new(),
+            connections: Vec::new(),
+            free: Vec::new(),
+            waiting: Vec::new(),
+            backlogged: Vec::new(),
+            expired: Vec::new(),
+            released: Vec::new(),
+            outputs: Vec::new(),
+            timeouts,
+        })
+    }
+
+    /// Get the listeners of the reactor, none once it stopped accepting the
+    /// connections.
+    pub fn listeners(&self) -> &[Listener] {
+        &self.listeners
+    }
+
+    /// Accept the pending connections, then close the listeners, so the next
+    /// clients are refused instead of waiting in its backlog.
+    ///
+    /// The accepted connections, the running listeners and the responses being
+    /// written go on, until [`Reactor::is_idle()`].
+    ///
+    /// # Parameters
+    ///
+    /// - `requests`: The buffer receiving the requests whose head is already
+    /// received.
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the deregistration of the listeners, or nothing if
+    /// all is good.
+    pub fn stop_accepting(&mut self, requests: &mut Vec<Request>) -> io::Result<()> {
+        for index in 0..self.listeners.len() {
+            self.accept(index, requests);
+        }
+
+        for listener in std::mem::take(&mut self.listeners) {
+            self.poller.deregister(&listener)?;
+        }
+
+        Ok(())
+    }
+
+    /// Get the amount of open connections: reading their head, processed by a
+    /// listener, or writing their response.
+    pub fn connections(&self) -> usize {
+        self.connections.len() - self.free.len()
+    }
+
+    /// Indicate if the reactor has no open connection and no asynchronous task.
+    pub fn is_idle(&self) -> bool {
+        self.connections() == 0 && self.executor.len() == 0
+    }
+
+    /// Execute the `future` on the reactor, until its end.
+    pub fn spawn(&mut self, future: impl Future<Output = ()> + Send + 'static) {
+        self.executor.spawn(future);
+    }
+
+    /// Get the amount of asynchronous tasks not ended.
+    pub fn tasks(&self) -> usize {
+        self.executor.len()
+    }
+
+    /// Execute the woken tasks, then wait for the events, at most `max_wait` or
+    /// until the next timer, and process them.
+    ///
+    /// # Parameters
+    ///
+    /// - `max_wait`: The maximal duration of the wait.
+    /// - `requests`: The buffer receiving the requests whose head is read. Their
+    /// stream is in blocking mode, and their response is handed over to the
+    /// reactor by [`Response::send()`].
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the wait of the poller, or nothing if all is good.
+    /// A connection which cannot be accepted is dropped with a warning, without
+    /// error.
+    pub fn turn(&mut self, max_wait: Duration, requests: &mut Vec<Request>) -> io::Result<()> {
+        self.executor.run();
+
+        let timeout = if self.executor.has_ready() {
+            Duration::ZERO
+        } else {
+            Timers::with_current(|timers| timers.next_deadline()).map_or(max_wait, |deadline| {
+                deadline
+                    .saturating_duration_since(Instant::now())
+                    .min(max_wait)
+            })
+        };
+
+        self.poller.wait(&mut self.events, Some(timeout))?;
+
+        // The listeners are edge-triggered, their pending connections are not
+        // notified again.
+        for index in std::mem::take(&mut self.backlogged) {
+            self.accept(index, requests);
+        }
+
+        for index in 0..self.events.len() {
+            match self.events[index].token {
+                Self::NOTIFICATIONS => self.receive_outputs(),
+                token if token < Self::FIRST_CONNECTION => {
+                    self.accept((token - Self::FIRST_LISTENER) as usize, requests)
+                }
+                _ => self.ready(self.events[index], requests),
+            }
+        }
+
+        Timers::with_current(|timers| timers.fire(Instant::now(), &mut self.expired));
+        for token in std::mem::take(&mut self.expired) {
+            match self.remove(token) {
+                Some(Slot::Reading(connection)) => {
+                    debug!(token = token; "Connection closed: the head of its request is late.");
+                    let _ = Response::reject_request_timeout(connection.into_stream());
+                }
+                Some(Slot::Writing(output, _)) => {
+                    debug!(token = token; "Connection closed: the client does not read its response.");
+                    output.abort();
+                }
+                // The watched connections have no deadline.
+                Some(Slot::Handling(..)) | None => {}
+            }
+        }
+        self.executor.run();
+
+        Ok(())
+    }
+
+    /// Accept all pending connections of the listener `index`, and read the
+    /// head of their requests.
+    ///
+    /// If the accept or the registration of a connection fails, like when the
+    /// process has no descriptor left, the connection is dropped and the
+    /// listener is accepted again at the next turn, so the server keeps serving
+    /// its open connections.
+    #[doc(hidden)]
+    fn accept(&mut self, index: usize, requests: &mut Vec<Request>) {
+        loop {
+            let Some(listener) = self.listeners.get(index) else {
+                return;
+            };
+
+            let error = match listener.accept() {
+                Ok(stream) => match self.open(stream) {
+                    Ok(token) => {
+                        // The head can be already received.
+                        self.read(token, requests);
+                        continue;
+                    }
+                    Err(error) => error,
+                },
+                Err(error) if error.kind() == ErrorKind::WouldBlock => return,
+                Err(error) if error.kind() == ErrorKind::Interrupted => continue,
+                // The client left before the accept.
+                Err(error) if error.kind() == ErrorKind::ConnectionAborted => continue,
+                Err(error) => error,
+            };
+
+            warning!(listener = index, error = error; "Connection not accepted; retrying at the next turn.");
+            if !self.backlogged.contains(&index) {
+                self.backlogged.push(index);
+            }
+            return;
+        }
+    }
+
+    /// Register the accepted `stream`, with the deadline of its head.
+    ///
+    /// # Returns
+    ///
+    /// Returns the token of the connection, or the error of the system. On
+    /// error, the stream is closed.
+    #[doc(hidden)]
+    fn open(&mut self, stream: Stream) -> io::Result<u64> {
+        stream.set_nonblocking(true)?;
+        stream.set_nodelay(true)?;
+
+        let token = self.allocate();
+        if let Err(error) = self.poller.register(&stream, token, Interest::Read) {
+            self.free.push((token - Self::FIRST_CONNECTION) as usize);
+            return Err(error);
+        }
+        let timer = self.arm(token, self.timeouts.header());
+        self.insert(token, Slot::Reading(Connection::new(stream, timer)));
+
+        Ok(token)
+    }
+
+    /// Process the readiness `event` of a connection.
+    #[doc(hidden)]
+    fn ready(&mut self, event: Event, requests: &mut Vec<Request>) {
+        let token = event.token;
+
+        match self.slot_mut(token) {
+            Some(Slot::Reading(_)) => self.read(token, requests),
+            Some(Slot::Writing(..)) => self.write(token),
+            Some(Slot::Handling(stream, cancellation))
+                if event.closed || (event.half_closed && stream.is_reset()) =>
+            {
+                debug!(token = token; "Request cancelled: the client closed the connection.");
+                cancellation.cancel();
+            }
+            // The client only closed its side, it still waits the response.
+            Some(Slot::Handling(..)) => {}
+            // An event of a closed connection.
+            None => {}
+        }
+    }
+
+    /// Read the head of the connection `token`, and give its request once the
+    /// head is complete.
+    #[doc(hidden)]
+    fn read(&mut self, token: u64, requests: &mut Vec<Request>) {
+        let Some(Slot::Reading(connection)) = self.slot_mut(token) else {
+            return;
+        };
+
+        match connection.read_head() {
+            Progress::Pending => {}
+            Progress::Complete => {
+                let Some(Slot::Reading(connection)) = self.take(token) else {
+                    unreachable!("The connection reads its head");
+                };
+                let (head, stream) = connection.into_head();
+
+                match self.dispatch(token, &head, &stream) {
+                    Ok(request) => {
+                        let cancellation = request.cancellation();
+                        self.insert(token, Slot::Handling(stream, cancellation));
+                        requests.push(request);
+                    }
+                    Err(error) => {
+                        debug!(token = token, error = error; "Connection closed: invalid request.");
+                        let _ = self.poller.deregister(&stream);
+                        self.free.push((token - Self::FIRST_CONNECTION) as usize);
+                    }
+                }
+            }
+            Progress::Closed => {
+                self.remove(token);
+            }
+            Progress::TooLarge => {
+                debug!(token = token; "Connection closed: the head of its request is too large.");
+                self.remove(token);
+            }
+        }
+    }
+
+    /// Create the request of the `head` on a duplicate of the `stream`, and watch
+    /// the `stream` for the hang-up of the client until the ticket of the request
+    /// is dropped.
+    ///
+    /// # Returns
+    ///
+    /// Returns the request, in blocking mode, or the error of its head or of the
+    /// system.
+    #[doc(hidden)]
+    fn dispatch(
+        &mut self,
+        token: u64,
+        head: &str,
+        stream: &Stream,
+    ) -> Result<Request, Box<dyn Error>> {
+        self.poller.modify(stream, token, Interest::Hangup)?;
+
+        // The mode is shared by the duplicates, the reactor only waits on its own.
+        let duplicate = stream.try_clone()?;
+        duplicate.set_nonblocking(false)?;
+        duplicate.set_write_timeout(Some(self.timeouts.write()))?;
+
+        let request = Request::parse(head, duplicate)?;
+        let ticket = Ticket::new(token, self.outbox.clone(), Cancellation::default());
+
+        Ok(request.with_ticket(ticket))
+    }
+
+    /// Take the responses handed over to the reactor, resume the streamed
+    /// responses waiting their next bytes, and stop watching the released
+    /// connections.
+    #[doc(hidden)]
+    fn receive_outputs(&mut self) {
+        let mut buffer = [0; 64];
+        while matches!(self.notifications.read(&mut buffer), Ok(read) if read > 0) {}
+        // The next notifications write again, the queues are read after.
+        self.notifier.reset();
+
+        self.outbox.take(&mut self.outputs);
+        for output in std::mem::take(&mut self.outputs) {
+            let token = self.allocate();
+
+            let registered = output.stream().set_nonblocking(true).and_then(|()| {
+                self.poller
+                    .register(output.stream(), token, Interest::Write)
+            });
+            if registered.is_err() {
+                self.free.push((token - Self::FIRST_CONNECTION) as usize);
+                output.abort();
+                continue;
+            }
+
+            self.insert(token, Slot::Writing(output, None));
+            self.write(token);
+        }
+
+        for token in std::mem::take(&mut self.waiting) {
+            self.write(token);
+        }
+
+        self.outbox.take_released(&mut self.released);
+        for token in std::mem::take(&mut self.released) {
+            if let Some(Slot::Handling(..)) = self.slot_mut(token) {
+                self.remove(token);
+            }
+        }
+    }
+
+    /// Write the queued bytes of the response of the connection `token`, and
+    /// close the connection once the response is written.
+    #[doc(hidden)]
+    fn write(&mut self, token: u64) {
+        let Some(Slot::Writing(output, timer)) = self.slot_mut(token) else {
+            return;
+        };
+
+        let flush = output.flush();
+        if let Some(previous) = timer.take() {
+            Timers::with_current(|timers| timers.cancel(previous));
+        }
+
+        match flush {
+            // The deadline restarts at each progress of the write.
+            Flush::Blocked => {
+                let next = self.arm(token, self.timeouts.write());
+                if let Some(Slot::Writing(_, timer)) = self.slot_mut(token) {
+                    *timer = Some(next);
+                }
+            }
+            Flush::Waiting => self.waiting.push(token),
+            Flush::Done => {
+                self.remove(token);
+            }
+            Flush::Failed => {
+                if let Some(Slot::Writing(output, _)) = self.remove(token) {
+                    output.abort();
+                }
+            }
+        }
+    }
+
+    /// Add a timer closing the connection `token` after the `duration`.
+    #[doc(hidden)]
+    fn arm(&self, token: u64, duration: Duration) -> TimerId {
+        let deadline = Instant::now() + duration;
+        Timers::with_current(|timers| timers.insert(deadline, Expiry::Connection(token)))
+    }
+
+    /// Reserve the token of a new connection.
+    #[doc(hidden)]
+    fn allocate(&mut self) -> u64 {
+        let index = self.free.pop().unwrap_or_else(|| {
+            self.connections.push(None);
+            self.connections.len() - 1
+        });
+
+        Self::FIRST_CONNECTION + index as u64
+    }
+
+    /// Put the `slot` of the connection `token`.
+    #[doc(hidden)]
+    fn insert(&mut self, token: u64, slot: Slot) {
+        self.connections[(token - Self::FIRST_CONNECTION) as usize] = Some(slot);
+    }
+
+    /// Get the connection `token`, if it is alive.
+    #[doc(hidden)]
+    fn slot_mut(&mut self, token: u64) -> Option<&mut Slot> {
+        let index = usize::try_from(token.checked_sub(Self::FIRST_CONNECTION)?).ok()?;
+        self.connections.get_mut(index)?.as_mut()
+    }
+
+    /// Remove the connection `token`, and cancel its deadline.
+    ///
+    /// # Returns
+    ///
+    /// Returns the connection, or [`None`] if it is already closed.
+    #[doc(hidden)]
+    fn remove(&mut self, token: u64) -> Option<Slot> {
+        let slot = self.take(token)?;
+
+        // The duplicate of the request can keep the socket open.
+        if let Slot::Handling(stream, _) = &slot {
+            let _ = self.poller.deregister(stream);
+        }
+        self.free.push((token - Self::FIRST_CONNECTION) as usize);
+
+        Some(slot)
+    }
+
+    /// Take the connection `token` and cancel its deadline, keeping its token
+    /// reserved.
+    ///
+    /// # Returns
+    ///
+    /// Returns the connection, or [`None`] if it is already closed.
+    #[doc(hidden)]
+    fn take(&mut self, token: u64) -> Option<Slot> {
+        let index = usize::try_from(token.checked_sub(Self::FIRST_CONNECTION)?).ok()?;
+        let slot = self.connections.get_mut(index)?.take()?;
+
+        let timer = match &slot {
+            Slot::Reading(connection) => Some(connection.timer()),
+            Slot::Writing(_, timer) => *timer,
+            Slot::Handling(..) => None,
+        };
+        if let Some(timer) = timer {
+            Timers::with_current(|timers| timers.cancel(timer));
+        }
+
+        Some(slot)
+    }
+}
+
+impl Drop for Reactor {
+    /// Close the connections, stop the producers of their responses, and cancel
+    /// the running listeners.
+    fn drop(&mut self) {
+        for output in self.outbox.close() {
+            output.abort();
+        }
+
+        for slot in self.connections.drain(..).flatten() {
+            match slot {
+                Slot::Writing(output, _) => output.abort(),
+                Slot::Handling(_, cancellation) => cancellation.cancel(),
+                Slot::Reading(_) => {}
+            }
+        }
+    }
+}
+
+/// A connection of the [`Reactor`].
+#[derive(Debug)]
+#[doc(hidden)]
+enum Slot {
+    /// The reactor reads the head of the request.
+    Reading(Connection),
+
+    /// The listener processes the request, the reactor watches the hang-up of
+    /// the client on its own duplicate of the stream.
+    Handling(Stream, Cancellation),
+
+    /// The reactor writes the response, with the timer of its deadline while
+    /// the socket is full.
+    Writing(Output, Option<TimerId>),
+}
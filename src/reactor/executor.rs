@@ -0,0 +1,181 @@
+use std::fmt::{Debug, Formatter};
+use std::future::Future;
+use std::panic::{catch_unwind, AssertUnwindSafe};
+use std::pin::Pin;
+use std::sync::{Arc, Mutex};
+use std::task::{Context, Poll, Wake, Waker};
+
+use super::notifier::Notifier;
+use crate::logging::error;
+
+/// A future executed by the [`Executor`], until its end.
+pub type Task = Pin<Box<dyn Future<Output = ()> + Send>>;
+
+/// The executor of the tasks of a reactor.
+///
+/// A task is polled only when its waker is woken, so a waiting task costs only
+/// its memory, not a thread. The wakers can be woken from any thread: the woken
+/// tasks are queued, and the reactor is notified to poll them.
+///
+/// # How to use it?
+///
+/// ```rust
+/// // Logic in the reactor in `src/reactor/event_loop.rs`.
+///
+/// use std::os::unix::net::UnixStream;
+/// use std::sync::Arc;
+///
+/// use crate::reactor::executor::Executor;
+/// use crate::reactor::notifier::Notifier;
+///
+/// let (sender, _receiver) = UnixStream::pair().unwrap();
+/// let mut executor = Executor::new(Arc::new(Notifier::new(sender)));
+///
+/// executor.spawn(async { println!("Hello") });
+/// executor.run();
+/// ```
+pub struct Executor {
+    #[doc(hidden)]
+    tasks: Vec<Option<(Task, Waker)>>,
+    #[doc(hidden)]
+    free: Vec<usize>,
+    #[doc(hidden)]
+    queue: Arc<ReadyQueue>,
+    #[doc(hidden)]
+    batch: Vec<usize>,
+}
+
+impl Executor {
+    /// Create the executor.
+    ///
+    /// # Parameters
+    ///
+    /// - `notifier`: The wake-up of the reactor when a task is woken.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Executor`].
+    pub fn new(notifier: Arc<Notifier>) -> Executor {
+        Self {
+            tasks: Vec::new(),
+            free: Vec::new(),
+            queue: Arc::new(ReadyQueue {
+                ids: Mutex::new(Vec::new()),
+                notifier,
+            }),
+            batch: Vec::new(),
+        }
+    }
+
+    /// Add the `future` to the tasks, it is polled on the next run.
+    pub fn spawn(&mut self, future: impl Future<Output = ()> + Send + 'static) {
+        let id = self.free.pop().unwrap_or_else(|| {
+            self.tasks.push(None);
+            self.tasks.len() - 1
+        });
+
+        let waker = Waker::from(Arc::new(TaskWaker {
+            id,
+            queue: Arc::clone(&self.queue),
+        }));
+
+        self.tasks[id] = Some((Box::pin(future), waker));
+        self.queue.push(id);
+    }
+
+    /// Poll the woken tasks, and drop the ended ones.
+    ///
+    /// A task which panics is dropped, the panic does not reach the reactor.
+    pub fn run(&mut self) {
+        std::mem::swap(
+            &mut self.batch,
+            &mut self.queue.ids.lock().expect("Cannot lock the woken tasks"),
+        );
+
+        for index in 0..self.batch.len() {
+            let id = self.batch[index];
+            let Some((task, waker)) = self.tasks[id].as_mut() else {
+                // A waker of an ended task.
+                continue;
+            };
+
+            let mut context = Context::from_waker(waker);
+            match catch_unwind(AssertUnwindSafe(|| task.as_mut().poll(&mut context))) {
+                Ok(Poll::Pending) => continue,
+                Ok(Poll::Ready(())) => {}
+                Err(_) => error!(task = id; "Task ended with a panic."),
+            }
+
+            self.tasks[id] = None;
+            self.free.push(id);
+        }
+
+        self.batch.clear();
+    }
+
+    /// Indicate if tasks are woken, and wait to be polled.
+    pub fn has_ready(&self) -> bool {
+        !self
+            .queue
+            .ids
+            .lock()
+            .expect("Cannot lock the woken tasks")
+            .is_empty()
+    }
+
+    /// Get the amount of tasks not ended.
+    pub fn len(&self) -> usize {
+        self.tasks.len() - self.free.len()
+    }
+}
+
+impl Debug for Executor {
+    fn fmt(&self, f: &mut Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("Executor")
+            .field("tasks", &self.len())
+            .field("queue", &self.queue)
+            .finish()
+    }
+}
+
+/// The identifiers of the woken tasks.
+#[derive(Debug)]
+#[doc(hidden)]
+struct ReadyQueue {
+    #[doc(hidden)]
+    ids: Mutex<Vec<usize>>,
+    #[doc(hidden)]
+    notifier: Arc<Notifier>,
+}
+
+impl ReadyQueue {
+    /// Queue the task `id`, and notify the reactor.
+    #[doc(hidden)]
+    fn push(&self, id: usize) {
+        self.ids
+            .lock()
+            .expect("Cannot lock the woken tasks")
+            .push(id);
+        self.notifier.notify();
+    }
+}
+
+/// The waker of a task, queuing its identifier.
+#[derive(Debug)]
+#[doc(hidden)]
+struct TaskWaker {
+    #[doc(hidden)]
+    id: usize,
+    #[doc(hidden)]
+    queue: Arc<ReadyQueue>,
+}
+
+impl Wake for TaskWaker {
+    fn wake(self: Arc<Self>) {
+        self.queue.push(self.id);
+    }
+
+    fn wake_by_ref(self: &Arc<Self>) {
+        self.queue.push(self.id);
+    }
+}
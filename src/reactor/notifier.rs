@@ -0,0 +1,67 @@
+use std::io::Write;
+use std::os::unix::net::UnixStream;
+use std::sync::atomic::{AtomicBool, Ordering};
+
+/// The wake-up of a reactor from any thread.
+///
+/// The notifier writes one byte in a socket registered in the poller of the
+/// reactor. The byte is written only once until the reactor resets the
+/// notifier, so many notifications cost one system call.
+///
+/// # How to use it?
+///
+/// ```rust
+/// // Logic in the reactor in `src/reactor/event_loop.rs`.
+///
+/// use std::os::unix::net::UnixStream;
+///
+/// use crate::reactor::notifier::Notifier;
+///
+/// let (sender, _receiver) = UnixStream::pair().unwrap();
+/// sender.set_nonblocking(true).unwrap();
+///
+/// let notifier = Notifier::new(sender);
+/// notifier.notify();
+///
+/// // The reactor reads the byte, then resets the notifier.
+/// notifier.reset();
+/// ```
+#[derive(Debug)]
+pub struct Notifier {
+    #[doc(hidden)]
+    notified: AtomicBool,
+    #[doc(hidden)]
+    sender: UnixStream,
+}
+
+impl Notifier {
+    /// Create the notifier writing in the `sender`.
+    ///
+    /// # Parameters
+    ///
+    /// - `sender`: The socket written to wake up the reactor. It must be in
+    /// non-blocking mode.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Notifier`].
+    pub fn new(sender: UnixStream) -> Notifier {
+        Self {
+            notified: AtomicBool::new(false),
+            sender,
+        }
+    }
+
+    /// Wake up the reactor, if it is not already notified.
+    pub fn notify(&self) {
+        if !self.notified.swap(true, Ordering::AcqRel) {
+            // A full socket already holds a notification.
+            let _ = (&self.sender).write(&[1]);
+        }
+    }
+
+    /// Allow the next notification, before the reactor reads its queues.
+    pub fn reset(&self) {
+        self.notified.store(false, Ordering::Release);
+    }
+}
@@ -0,0 +1,539 @@
+use std::collections::VecDeque;
+use std::io::{self, ErrorKind, Write};
+use std::os::fd::AsRawFd;
+use std::sync::{Arc, Condvar, Mutex};
+
+use super::cancellation::Cancellation;
+use super::notifier::Notifier;
+use super::timer::Timers;
+use crate::requests::FileRegion;
+use crate::sockets::Stream;
+
+/// The handle to give the finished responses to the reactor.
+///
+/// The reactor writes the responses when their sockets become writable, so the
+/// worker is free as soon as its response is handed over, even if the client
+/// reads it slowly.
+///
+/// # How to use it?
+///
+/// ```rust
+/// // Logic in the response in `src/requests/response.rs`.
+///
+/// use std::io::Write;
+///
+/// use crate::reactor::{Cancellation, Outbox, Segment};
+///
+/// fn send(outbox: &Outbox, stream: Stream) {
+///     outbox.send(stream, vec![Segment::Bytes(b"HTTP/1.1 204 NO CONTENT\r\n\r\n".to_vec())]);
+/// }
+///
+/// fn stream(outbox: &Outbox, stream: Stream, cancellation: Cancellation) {
+///     let head = b"HTTP/1.1 200 OK\r\n\r\n".to_vec();
+///     let mut writer = outbox.send_streamed(stream, head, cancellation);
+///     writer.write_all(b"Hello").unwrap();
+///     // The response ends when the writer is dropped.
+/// }
+/// ```
+#[derive(Debug, Clone)]
+pub struct Outbox {
+    #[doc(hidden)]
+    shared: Arc<Handoff>,
+}
+
+impl Outbox {
+    /// Create the outbox of a reactor.
+    ///
+    /// # Parameters
+    ///
+    /// - `notifier`: The wake-up of the reactor when a response is handed over.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Outbox`].
+    pub fn new(notifier: Arc<Notifier>) -> Outbox {
+        Self {
+            shared: Arc::new(Handoff {
+                outputs: Mutex::new(Some(Vec::new())),
+                released: Mutex::new(Vec::new()),
+                notifier,
+            }),
+        }
+    }
+
+    /// Give the `segments` to write on the `stream` to the reactor, which closes
+    /// the connection after them.
+    pub fn send(&self, stream: Stream, segments: Vec<Segment>) {
+        self.hand_over(Output::new(stream, segments.into(), None));
+    }
+
+    /// Give the `head` to write on the `stream` to the reactor, followed by the
+    /// bytes of the returned writer.
+    ///
+    /// The writer blocks while the queue of the connection contains
+    /// [`Pipe::CAPACITY`] bytes, so the producer follows the speed of the
+    /// client. On the thread of the reactor, the writer never blocks.
+    ///
+    /// # Parameters
+    ///
+    /// - `stream`: The connection of the response.
+    /// - `head`: The head of the response.
+    /// - `cancellation`: The token of the request, the writes fail once it is
+    /// cancelled so the producer stops.
+    ///
+    /// # Returns
+    ///
+    /// Returns the writer of the body. The response ends when it is dropped.
+    pub fn send_streamed(
+        &self,
+        stream: Stream,
+        head: Vec<u8>,
+        cancellation: Cancellation,
+    ) -> PipeWriter {
+        let pipe = Arc::new(Pipe::default());
+        self.hand_over(Output::new(
+            stream,
+            VecDeque::from([Segment::Bytes(head)]),
+            Some(Arc::clone(&pipe)),
+        ));
+
+        PipeWriter {
+            pipe,
+            outbox: self.clone(),
+            cancellation,
+        }
+    }
+
+    /// Move the handed over responses at the end of `outputs`.
+    pub fn take(&self, outputs: &mut Vec<Output>) {
+        if let Some(pending) = self.lock().as_mut() {
+            outputs.append(pending);
+        }
+    }
+
+    /// Stop watching the connection `token`, its listener is done.
+    ///
+    /// # Panics
+    ///
+    /// - If the lock is poisoned.
+    pub fn release(&self, token: u64) {
+        self.shared
+            .released
+            .lock()
+            .expect("Cannot lock the released connections")
+            .push(token);
+
+        self.shared.notifier.notify();
+    }
+
+    /// Move the tokens of the released connections at the end of `tokens`.
+    ///
+    /// # Panics
+    ///
+    /// - If the lock is poisoned.
+    pub fn take_released(&self, tokens: &mut Vec<u64>) {
+        tokens.append(
+            &mut self
+                .shared
+                .released
+                .lock()
+                .expect("Cannot lock the released connections"),
+        );
+    }
+
+    /// Refuse the next responses, because the reactor stops.
+    ///
+    /// # Returns
+    ///
+    /// Returns the responses handed over but not taken.
+    pub fn close(&self) -> Vec<Output> {
+        self.lock().take().unwrap_or_default()
+    }
+
+    /// Queue the `output`, and wake up the reactor.
+    #[doc(hidden)]
+    fn hand_over(&self, output: Output) {
+        match self.lock().as_mut() {
+            Some(outputs) => outputs.push(output),
+            // The reactor is stopped, the connection is closed.
+            None => return output.abort(),
+        }
+
+        self.shared.notifier.notify();
+    }
+
+    /// Lock the handed over responses.
+    ///
+    /// # Panics
+    ///
+    /// - If the lock is poisoned.
+    #[doc(hidden)]
+    fn lock(&self) -> std::sync::MutexGuard<'_, Option<Vec<Output>>> {
+        self.shared
+            .outputs
+            .lock()
+            .expect("Cannot lock the handed over responses")
+    }
+}
+
+/// The shared state of the [`Outbox`].
+#[derive(Debug)]
+#[doc(hidden)]
+struct Handoff {
+    /// The responses not yet taken by the reactor, or [`None`] if it is stopped.
+    #[doc(hidden)]
+    outputs: Mutex<Option<Vec<Output>>>,
+    /// The connections whose listener is done, cf.[`Ticket`](super::Ticket).
+    #[doc(hidden)]
+    released: Mutex<Vec<u64>>,
+    #[doc(hidden)]
+    notifier: Arc<Notifier>,
+}
+
+/// A part of a response to write, cf.[`Outbox::send()`].
+#[derive(Debug)]
+pub enum Segment {
+    /// Bytes in memory.
+    Bytes(Vec<u8>),
+
+    /// A region of a file, sent without copying it in memory on Linux.
+    File(FileRegion),
+}
+
+impl Segment {
+    /// Get the amount of bytes of the segment.
+    pub fn len(&self) -> u64 {
+        match self {
+            Self::Bytes(bytes) => bytes.len() as u64,
+            Self::File(region) => region.length(),
+        }
+    }
+}
+
+/// The state of an [`Output`], after [`Output::flush()`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Flush {
+    /// The socket is full, the output waits that it becomes writable.
+    Blocked,
+
+    /// The queue is empty, the output waits the next bytes of its producer.
+    Waiting,
+
+    /// The response is completely written.
+    Done,
+
+    /// The client closed the connection, or the connection is in error.
+    Failed,
+}
+
+/// A response handed over to the reactor, with its connection.
+#[derive(Debug)]
+pub struct Output {
+    #[doc(hidden)]
+    stream: Stream,
+    #[doc(hidden)]
+    segments: VecDeque<Segment>,
+    /// The amount of written bytes of the first segment.
+    #[doc(hidden)]
+    position: u64,
+    #[doc(hidden)]
+    pipe: Option<Arc<Pipe>>,
+}
+
+impl Output {
+    /// The maximal amount of bytes of a file sent by one system call.
+    #[doc(hidden)]
+    const FILE_CHUNK: u64 = 64 * 1024;
+
+    /// Create the output of the `segments`, followed by the bytes of the `pipe`.
+    #[doc(hidden)]
+    fn new(stream: Stream, segments: VecDeque<Segment>, pipe: Option<Arc<Pipe>>) -> Output {
+        Self {
+            stream,
+            segments,
+            position: 0,
+            pipe,
+        }
+    }
+
+    /// Get the stream of the output.
+    pub fn stream(&self) -> &Stream {
+        &self.stream
+    }
+
+    /// Write the queued bytes, until the socket is full or the queue is empty.
+    ///
+    /// The stream must be in non-blocking mode.
+    ///
+    /// # Returns
+    ///
+    /// Returns the [`Flush`] state of the output.
+    pub fn flush(&mut self) -> Flush {
+        loop {
+            let Some(segment) = self.segments.front() else {
+                match &self.pipe {
+                    None => return Flush::Done,
+                    Some(pipe) => match pipe.take(&mut self.segments) {
+                        _ if !self.segments.is_empty() => continue,
+                        true => return Flush::Done,
+                        false => return Flush::Waiting,
+                    },
+                }
+            };
+
+            if self.position == segment.len() {
+                self.segments.pop_front();
+                self.position = 0;
+                continue;
+            }
+
+            let more = self.segments.len() > 1;
+            let written = match segment {
+                Segment::Bytes(bytes) => {
+                    Self::send(&self.stream, &bytes[self.position as usize..], more)
+                }
+                Segment::File(region) => Self::send_file(&self.stream, region, self.position),
+            };
+
+            match written {
+                Ok(0) => return Flush::Failed,
+                Ok(written) => self.position += written as u64,
+                Err(error) if error.kind() == ErrorKind::WouldBlock => return Flush::Blocked,
+                Err(error) if error.kind() == ErrorKind::Interrupted => {}
+                Err(_) => return Flush::Failed,
+            }
+        }
+    }
+
+    /// Drop the output, and stop its producer.
+    pub fn abort(self) {
+        if let Some(pipe) = &self.pipe {
+            pipe.fail();
+        }
+    }
+
+    /// Write the `bytes` to the `stream`, with `MSG_MORE` if `more` bytes follow
+    /// them, to coalesce them with the next write.
+    ///
+    /// # Returns
+    ///
+    /// Returns the amount of written bytes, or the error of the system call.
+    #[cfg(target_os = "linux")]
+    #[doc(hidden)]
+    fn send(stream: &Stream, bytes: &[u8], more: bool) -> io::Result<usize> {
+        let flags = libc::MSG_NOSIGNAL | if more { libc::MSG_MORE } else { 0 };
+
+        // SAFETY: The file descriptor is owned by the stream, and the pointer
+        // and the length come from the same living slice.
+        let written = unsafe {
+            libc::send(
+                stream.as_raw_fd(),
+                bytes.as_ptr().cast(),
+                bytes.len(),
+                flags,
+            )
+        };
+
+        match written {
+            -1 => Err(io::Error::last_os_error()),
+            written => Ok(written as usize),
+        }
+    }
+
+    #[cfg(not(target_os = "linux"))]
+    #[doc(hidden)]
+    fn send(mut stream: &Stream, bytes: &[u8], _more: bool) -> io::Result<usize> {
+        stream.write(bytes)
+    }
+
+    /// Write the bytes of the `region` after the `position` to the `stream`, with
+    /// `sendfile`.
+    ///
+    /// # Returns
+    ///
+    /// Returns the amount of written bytes, or the error of the system call.
+    #[cfg(target_os = "linux")]
+    #[doc(hidden)]
+    fn send_file(stream: &Stream, region: &FileRegion, position: u64) -> io::Result<usize> {
+        let mut offset = (region.offset() + position) as libc::off_t;
+        let count = (region.length() - position).min(Self::FILE_CHUNK) as usize;
+
+        // SAFETY: The file descriptors are owned by the stream and the region, and
+        // the offset lives during the call.
+        let written = unsafe {
+            libc::sendfile(
+                stream.as_raw_fd(),
+                region.file().as_raw_fd(),
+                &mut offset,
+                count,
+            )
+        };
+
+        match written {
+            -1 => Err(io::Error::last_os_error()),
+            // The file is shorter than the region.
+            0 => Err(ErrorKind::UnexpectedEof.into()),
+            written => Ok(written as usize),
+        }
+    }
+
+    #[cfg(not(target_os = "linux"))]
+    #[doc(hidden)]
+    fn send_file(mut stream: &Stream, region: &FileRegion, position: u64) -> io::Result<usize> {
+        use std::os::unix::fs::FileExt;
+
+        let mut buffer = vec![0; (region.length() - position).min(Self::FILE_CHUNK) as usize];
+        let read = region
+            .file()
+            .read_at(&mut buffer, region.offset() + position)?;
+        if read == 0 {
+            return Err(ErrorKind::UnexpectedEof.into());
+        }
+
+        stream.write(&buffer[..read])
+    }
+}
+
+/// The bounded queue between the producer of a streamed response and the
+/// reactor.
+#[derive(Debug, Default)]
+pub struct Pipe {
+    #[doc(hidden)]
+    state: Mutex<PipeState>,
+    #[doc(hidden)]
+    space: Condvar,
+}
+
+impl Pipe {
+    /// The maximal amount of queued bytes, before the producer waits.
+    pub const CAPACITY: usize = 256 * 1024;
+
+    /// Queue the `chunk`, after waiting that the queue has space if the current
+    /// thread is not the thread of the reactor.
+    ///
+    /// # Returns
+    ///
+    /// Returns [`ErrorKind::BrokenPipe`] if the connection is closed, or nothing
+    /// if all is good.
+    ///
+    /// # Panics
+    ///
+    /// - If the lock is poisoned.
+    #[doc(hidden)]
+    fn push(&self, chunk: &[u8]) -> io::Result<()> {
+        let mut state = self.lock();
+
+        // The reactor cannot wait itself.
+        if !Timers::is_driven() {
+            while !state.failed && state.queued >= Self::CAPACITY {
+                state = self.space.wait(state).expect("Cannot lock the pipe");
+            }
+        }
+
+        if state.failed {
+            return Err(ErrorKind::BrokenPipe.into());
+        }
+
+        state.queued += chunk.len();
+        state.chunks.push_back(chunk.to_vec());
+
+        Ok(())
+    }
+
+    /// Indicate that the producer ended the response.
+    #[doc(hidden)]
+    fn close(&self) {
+        self.lock().closed = true;
+    }
+
+    /// Indicate that the connection is closed, and wake up the producer.
+    #[doc(hidden)]
+    fn fail(&self) {
+        let mut state = self.lock();
+        state.failed = true;
+        state.chunks.clear();
+        state.queued = 0;
+
+        self.space.notify_all();
+    }
+
+    /// Move the queued chunks at the end of `segments`, and wake up the producer.
+    ///
+    /// # Returns
+    ///
+    /// Returns `true` if the producer ended the response.
+    #[doc(hidden)]
+    fn take(&self, segments: &mut VecDeque<Segment>) -> bool {
+        let mut state = self.lock();
+        segments.extend(state.chunks.drain(..).map(Segment::Bytes));
+        state.queued = 0;
+
+        self.space.notify_all();
+        state.closed
+    }
+
+    /// Lock the state of the pipe.
+    ///
+    /// # Panics
+    ///
+    /// - If the lock is poisoned.
+    #[doc(hidden)]
+    fn lock(&self) -> std::sync::MutexGuard<'_, PipeState> {
+        self.state.lock().expect("Cannot lock the pipe")
+    }
+}
+
+/// The state of a [`Pipe`].
+#[derive(Debug, Default)]
+#[doc(hidden)]
+struct PipeState {
+    #[doc(hidden)]
+    chunks: VecDeque<Vec<u8>>,
+    #[doc(hidden)]
+    queued: usize,
+    #[doc(hidden)]
+    closed: bool,
+    #[doc(hidden)]
+    failed: bool,
+}
+
+/// The writer of the body of a streamed response, cf.[`Outbox::send_streamed()`].
+///
+/// Each write is queued as one segment, so the writes should be buffered, like
+/// by a [`ChunkedWriter`](crate::requests::ChunkedWriter).
+#[derive(Debug)]
+pub struct PipeWriter {
+    #[doc(hidden)]
+    pipe: Arc<Pipe>,
+    #[doc(hidden)]
+    outbox: Outbox,
+    #[doc(hidden)]
+    cancellation: Cancellation,
+}
+
+impl Write for PipeWriter {
+    fn write(&mut self, buf: &[u8]) -> io::Result<usize> {
+        if self.cancellation.is_cancelled() {
+            return Err(ErrorKind::ConnectionAborted.into());
+        }
+
+        if !buf.is_empty() {
+            self.pipe.push(buf)?;
+            self.outbox.shared.notifier.notify();
+        }
+
+        Ok(buf.len())
+    }
+
+    fn flush(&mut self) -> io::Result<()> {
+        Ok(())
+    }
+}
+
+impl Drop for PipeWriter {
+    /// End the response, even if the producer failed.
+    fn drop(&mut self) {
+        self.pipe.close();
+        self.outbox.shared.notifier.notify();
+    }
+}
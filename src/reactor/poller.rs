@@ -0,0 +1,321 @@
+use std::io;
+use std::os::fd::{AsRawFd, RawFd};
+use std::time::Duration;
+
+/// The readiness awaited on a file descriptor registered in the [`Poller`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Interest {
+    /// Wait that the descriptor is readable, or that the peer closes it.
+    Read,
+
+    /// Wait that the descriptor is writable, or that the peer closes it.
+    Write,
+
+    /// Wait only that the peer closes the descriptor, with `EPOLLRDHUP` on Linux.
+    /// Elsewhere, only a complete close or an error is seen.
+    Hangup,
+}
+
+/// The readiness of a file descriptor, returned by [`Poller::wait()`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Event {
+    /// The token given at the registration of the descriptor.
+    pub token: u64,
+    /// The descriptor is readable.
+    pub readable: bool,
+    /// The descriptor is writable.
+    pub writable: bool,
+    /// The peer closed its side of the connection, with `EPOLLRDHUP` on Linux.
+    /// It can still wait the response, cf.[`Stream::is_reset()`][is_reset].
+    ///
+    /// <!-- References -->
+    ///
+    /// [is_reset]: crate::sockets::Stream::is_reset()
+    pub half_closed: bool,
+    /// The connection is closed in both directions, or the descriptor is in
+    /// error.
+    pub closed: bool,
+}
+
+/// The readiness notification of the system, `epoll` on Linux and `poll`
+/// elsewhere.
+///
+/// The descriptors are registered with a token, and with the edge-triggered
+/// mode on Linux: an event is returned once per readiness change, so the owner
+/// must read or write until [`io::ErrorKind::WouldBlock`].
+///
+/// # How to use it?
+///
+/// ```rust
+/// use std::net::TcpListener;
+///
+/// use crate::reactor::poller::{Interest, Poller};
+///
+/// let listener = TcpListener::bind("127.0.0.1:8000").unwrap();
+/// listener.set_nonblocking(true).unwrap();
+///
+/// let mut poller = Poller::new().unwrap();
+/// poller.register(&listener, 0, Interest::Read).unwrap();
+///
+/// let mut events = Vec::new();
+/// poller.wait(&mut events, None).unwrap();
+/// ```
+#[derive(Debug)]
+pub struct Poller {
+    #[doc(hidden)]
+    #[cfg(target_os = "linux")]
+    epoll: std::os::fd::OwnedFd,
+    #[doc(hidden)]
+    #[cfg(not(target_os = "linux"))]
+    registrations: Vec<(RawFd, u64, Interest)>,
+}
+
+impl Poller {
+    /// The maximal amount of events returned by one wait.
+    #[doc(hidden)]
+    const EVENTS_CAPACITY: usize = 256;
+
+    /// Create the poller.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Poller`], or the error of the system.
+    #[cfg(target_os = "linux")]
+    pub fn new() -> io::Result<Poller> {
+        use std::os::fd::FromRawFd;
+
+        // SAFETY: The flags are valid, and the returned descriptor is checked.
+        let fd = unsafe { libc::epoll_create1(libc::EPOLL_CLOEXEC) };
+        if fd == -1 {
+            return Err(io::Error::last_os_error());
+        }
+
+        Ok(Self {
+            // SAFETY: The descriptor is valid and owned by nobody else.
+            epoll: unsafe { std::os::fd::OwnedFd::from_raw_fd(fd) },
+        })
+    }
+
+    #[cfg(not(target_os = "linux"))]
+    pub fn new() -> io::Result<Poller> {
+        Ok(Self {
+            registrations: Vec::new(),
+        })
+    }
+
+    /// Register the `source` with the `token`, to wait the `interest`.
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the system, or nothing if all is good.
+    pub fn register(
+        &mut self,
+        source: &impl AsRawFd,
+        token: u64,
+        interest: Interest,
+    ) -> io::Result<()> {
+        self.control(source.as_raw_fd(), token, Some(interest), true)
+    }
+
+    /// Change the `interest` of the registered `source`.
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the system, or nothing if all is good.
+    pub fn modify(
+        &mut self,
+        source: &impl AsRawFd,
+        token: u64,
+        interest: Interest,
+    ) -> io::Result<()> {
+        self.control(source.as_raw_fd(), token, Some(interest), false)
+    }
+
+    /// Unregister the `source`, before closing it.
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the system, or nothing if all is good.
+    pub fn deregister(&mut self, source: &impl AsRawFd) -> io::Result<()> {
+        self.control(source.as_raw_fd(), 0, None, false)
+    }
+
+    /// Wait the readiness of the registered descriptors.
+    ///
+    /// # Parameters
+    ///
+    /// - `events`: The buffer receiving the events, cleared before the wait.
+    /// - `timeout`: The maximal duration of the wait, or [`None`] to wait an
+    /// event.
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the system, or nothing if all is good. An interrupted
+    /// wait returns no event.
+    #[cfg(target_os = "linux")]
+    pub fn wait(&mut self, events: &mut Vec<Event>, timeout: Option<Duration>) -> io::Result<()> {
+        // SAFETY: An epoll event is plain data, valid when zeroed.
+        let mut buffer =
+            [unsafe { std::mem::zeroed::<libc::epoll_event>() }; Self::EVENTS_CAPACITY];
+        events.clear();
+
+        // SAFETY: The buffer lives during the call, and its length is given.
+        let count = unsafe {
+            libc::epoll_wait(
+                self.epoll.as_raw_fd(),
+                buffer.as_mut_ptr(),
+                Self::EVENTS_CAPACITY as libc::c_int,
+                Self::timeout_millis(timeout),
+            )
+        };
+
+        if count == -1 {
+            let error = io::Error::last_os_error();
+            return match error.kind() {
+                io::ErrorKind::Interrupted => Ok(()),
+                _ => Err(error),
+            };
+        }
+
+        events.extend(buffer[..count as usize].iter().map(|event| {
+            let flags = event.events as libc::c_int;
+
+            Event {
+                token: event.u64,
+                readable: flags & libc::EPOLLIN != 0,
+                writable: flags & libc::EPOLLOUT != 0,
+                half_closed: flags & libc::EPOLLRDHUP != 0,
+                closed: flags & (libc::EPOLLHUP | libc::EPOLLERR) != 0,
+            }
+        }));
+
+        Ok(())
+    }
+
+    #[cfg(not(target_os = "linux"))]
+    pub fn wait(&mut self, events: &mut Vec<Event>, timeout: Option<Duration>) -> io::Result<()> {
+        let mut descriptors: Vec<libc::pollfd> = self
+            .registrations
+            .iter()
+            .map(|(fd, _, interest)| libc::pollfd {
+                fd: *fd,
+                events: match interest {
+                    Interest::Read => libc::POLLIN,
+                    Interest::Write => libc::POLLOUT,
+                    // The hang-up and the errors are always returned.
+                    Interest::Hangup => 0,
+                },
+                revents: 0,
+            })
+            .collect();
+        events.clear();
+
+        // SAFETY: The descriptors live during the call, and their length is given.
+        let count = unsafe {
+            libc::poll(
+                descriptors.as_mut_ptr(),
+                descriptors.len() as libc::nfds_t,
+                Self::timeout_millis(timeout),
+            )
+        };
+
+        if count == -1 {
+            let error = io::Error::last_os_error();
+            return match error.kind() {
+                io::ErrorKind::Interrupted => Ok(()),
+                _ => Err(error),
+            };
+        }
+
+        events.extend(
+            descriptors
+                .iter()
+                .zip(self.registrations.iter())
+                .filter(|(descriptor, _)| descriptor.revents != 0)
+                .map(|(descriptor, (_, token, _))| Event {
+                    token: *token,
+                    readable: descriptor.revents & libc::POLLIN != 0,
+                    writable: descriptor.revents & libc::POLLOUT != 0,
+                    half_closed: false,
+                    closed: descriptor.revents & (libc::POLLHUP | libc::POLLERR) != 0,
+                }),
+        );
+
+        Ok(())
+    }
+
+    /// Convert the `timeout` in milliseconds, rounded up so the wait does not
+    /// end before a deadline.
+    #[doc(hidden)]
+    fn timeout_millis(timeout: Option<Duration>) -> libc::c_int {
+        timeout.map_or(-1, |timeout| {
+            let millis = timeout.as_nanos().div_ceil(1_000_000);
+            libc::c_int::try_from(millis).unwrap_or(libc::c_int::MAX)
+        })
+    }
+
+    /// Add, change or remove the registration of the `fd`.
+    #[cfg(target_os = "linux")]
+    #[doc(hidden)]
+    fn control(
+        &mut self,
+        fd: RawFd,
+        token: u64,
+        interest: Option<Interest>,
+        add: bool,
+    ) -> io::Result<()> {
+        let flags = match interest {
+            Some(Interest::Read) => libc::EPOLLIN,
+            Some(Interest::Write) => libc::EPOLLOUT,
+            Some(Interest::Hangup) | None => 0,
+        } | libc::EPOLLRDHUP
+            | libc::EPOLLET;
+
+        let mut event = libc::epoll_event {
+            events: flags as u32,
+            u64: token,
+        };
+        let operation = match (interest, add) {
+            (None, _) => libc::EPOLL_CTL_DEL,
+            (Some(_), true) => libc::EPOLL_CTL_ADD,
+            (Some(_), false) => libc::EPOLL_CTL_MOD,
+        };
+
+        // SAFETY: The descriptors are valid, and the event lives during the call.
+        let result = unsafe { libc::epoll_ctl(self.epoll.as_raw_fd(), operation, fd, &mut event) };
+
+        if result == 0 {
+            Ok(())
+        } else {
+            Err(io::Error::last_os_error())
+        }
+    }
+
+    #[cfg(not(target_os = "linux"))]
+    #[doc(hidden)]
+    fn control(
+        &mut self,
+        fd: RawFd,
+        token: u64,
+        interest: Option<Interest>,
+        add: bool,
+    ) -> io::Result<()> {
+        let index = self
+            .registrations
+            .iter()
+            .position(|(other, _, _)| *other == fd);
+
+        match (index, interest) {
+            (Some(index), None) => {
+                self.registrations.swap_remove(index);
+            }
+            (Some(index), Some(interest)) if !add => {
+                self.registrations[index] = (fd, token, interest)
+            }
+            (None, Some(interest)) if add => self.registrations.push((fd, token, interest)),
+            _ => return Err(io::ErrorKind::InvalidInput.into()),
+        }
+
+        Ok(())
+    }
+}
@@ -0,0 +1,67 @@
+use super::cancellation::Cancellation;
+use super::output::Outbox;
+
+/// The link between a request read by the reactor and its connection, which the
+/// reactor watches until the response is handed over.
+///
+/// The ticket gives the [`Outbox`] writing the response, and the
+/// [`Cancellation`] of the request. When it is dropped, after the send of the
+/// response or with a cancelled listener, the reactor stops watching the
+/// connection.
+#[derive(Debug)]
+pub struct Ticket {
+    #[doc(hidden)]
+    token: u64,
+    #[doc(hidden)]
+    outbox: Outbox,
+    #[doc(hidden)]
+    cancellation: Cancellation,
+}
+
+impl Ticket {
+    /// Create the ticket of the connection `token`.
+    ///
+    /// # Parameters
+    ///
+    /// - `token`: The token of the watched connection in the reactor.
+    /// - `outbox`: The outbox of the reactor.
+    /// - `cancellation`: The token cancelled when the client hangs up.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Ticket`].
+    pub fn new(token: u64, outbox: Outbox, cancellation: Cancellation) -> Ticket {
+        Self {
+            token,
+            outbox,
+            cancellation,
+        }
+    }
+
+    /// Get the [`Outbox`] writing the response.
+    pub fn outbox(&self) -> &Outbox {
+        &self.outbox
+    }
+
+    /// Release the watched connection, and get the [`Outbox`] to hand over the
+    /// response.
+    ///
+    /// The connection is released before the response is handed over, so the
+    /// close of the connection by the client after reading the response is not
+    /// seen as a cancellation.
+    pub fn into_outbox(self) -> Outbox {
+        self.outbox.clone()
+    }
+
+    /// Get the [`Cancellation`] of the request.
+    pub fn cancellation(&self) -> &Cancellation {
+        &self.cancellation
+    }
+}
+
+impl Drop for Ticket {
+    /// Release the watched connection.
+    fn drop(&mut self) {
+        self.outbox.release(self.token);
+    }
+}
@@ -0,0 +1,126 @@
+use std::time::Duration;
+
+/// The deadlines of the connections of the server.
+///
+/// # How to use it?
+///
+/// ```rust
+/// use std::time::Duration;
+///
+/// use crate::server::{Debug, Timeouts, WebServer};
+///
+/// let mut server = WebServer::new(5, Debug::False);
+/// server.set_timeouts(
+///     Timeouts::default()
+///         .with_header(Duration::from_secs(5))
+///         .with_handler(Duration::from_secs(10))
+///         .with_drain(Duration::from_secs(5)),
+/// );
+/// ```
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Timeouts {
+    #[doc(hidden)]
+    header: Duration,
+    #[doc(hidden)]
+    handler: Duration,
+    #[doc(hidden)]
+    write: Duration,
+    #[doc(hidden)]
+    drain: Duration,
+}
+
+impl Timeouts {
+    /// Set the maximal duration to receive the head of a request, since the
+    /// accept of its connection. The slow clients receive `408 REQUEST TIMEOUT`.
+    ///
+    /// # Panics
+    ///
+    /// - If `header` is zero.
+    pub fn with_header(mut self, header: Duration) -> Timeouts {
+        assert!(!header.is_zero(), "The header timeout must not be zero");
+
+        self.header = header;
+        self
+    }
+
+    /// Set the maximal duration of an asynchronous listener. The listeners
+    /// exceeding it are dropped, and their clients receive
+    /// `503 SERVICE UNAVAILABLE`.
+    ///
+    /// The synchronous listeners cannot be interrupted, so this deadline only
+    /// applies to the asynchronous ones.
+    ///
+    /// # Panics
+    ///
+    /// - If `handler` is zero.
+    pub fn with_handler(mut self, handler: Duration) -> Timeouts {
+        assert!(!handler.is_zero(), "The handler timeout must not be zero");
+
+        self.handler = handler;
+        self
+    }
+
+    /// Set the maximal duration of each write of a response. The write to a
+    /// client not reading its response fails after it.
+    ///
+    /// # Panics
+    ///
+    /// - If `write` is zero.
+    pub fn with_write(mut self, write: Duration) -> Timeouts {
+        assert!(!write.is_zero(), "The write timeout must not be zero");
+
+        self.write = write;
+        self
+    }
+
+    /// Set the maximal duration of the shutdown. The server stops accepting, then
+    /// lets the in-flight requests end and their responses be written during
+    /// `drain`, before closing the remaining connections.
+    ///
+    /// # Panics
+    ///
+    /// - If `drain` is zero.
+    pub fn with_drain(mut self, drain: Duration) -> Timeouts {
+        assert!(!drain.is_zero(), "The drain timeout must not be zero");
+
+        self.drain = drain;
+        self
+    }
+
+    /// Get the maximal duration to receive the head of a request.
+    pub fn header(&self) -> Duration {
+        self.header
+    }
+
+    /// Get the maximal duration of an asynchronous listener.
+    pub fn handler(&self) -> Duration {
+        self.handler
+    }
+
+    /// Get the maximal duration of each write of a response.
+    pub fn write(&self) -> Duration {
+        self.write
+    }
+
+    /// Get the maximal duration of the shutdown.
+    pub fn drain(&self) -> Duration {
+        self.drain
+    }
+}
+
+impl Default for Timeouts {
+    /// Create the [`Timeouts`] with 10 seconds to receive the head, 30 seconds
+    /// for the listeners and each write, and 10 seconds for the shutdown.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Timeouts`].
+    fn default() -> Self {
+        Self {
+            header: Duration::from_secs(10),
+            handler: Duration::from_secs(30),
+            write: Duration::from_secs(30),
+            drain: Duration::from_secs(10),
+        }
+    }
+}
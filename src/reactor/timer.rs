@@ -0,0 +1,195 @@
+use std::cell::{Cell, RefCell};
+use std::future::Future;
+use std::pin::Pin;
+use std::task::{Context, Poll, Waker};
+use std::time::{Duration, Instant};
+
+use super::wheel::{TimerId, TimerWheel};
+
+thread_local! {
+    /// The timers of the reactor of the current thread.
+    static TIMERS: RefCell<Timers> = RefCell::new(Timers::new(Instant::now()));
+
+    /// Indicate if a reactor fires the timers of the current thread.
+    static DRIVEN: Cell<bool> = const { Cell::new(false) };
+}
+
+/// The timers of a reactor: the sleeping tasks, and the deadlines of the
+/// connections.
+///
+/// The timers are owned by the thread of the reactor. The reactor waits until
+/// the next deadline, then wakes the tasks and closes the connections of the
+/// expired timers.
+pub type Timers = TimerWheel<Expiry>;
+
+/// The action of an expired timer of the reactor.
+#[derive(Debug)]
+pub enum Expiry {
+    /// Wake the task of a [`Sleep`].
+    Wake(Waker),
+
+    /// Close the connection with this token, its deadline is exceeded.
+    Connection(u64),
+}
+
+impl Timers {
+    /// Indicate that a reactor fires the timers of the current thread, so the
+    /// [`Sleep`] futures can be awaited on it.
+    pub fn drive_current_thread() {
+        DRIVEN.with(|driven| driven.set(true));
+    }
+
+    /// Indicate if a reactor fires the timers of the current thread, so it is
+    /// the thread of the reactor.
+    pub fn is_driven() -> bool {
+        DRIVEN.with(Cell::get)
+    }
+
+    /// Execute `function` with the timers of the current thread.
+    pub fn with_current<R>(function: impl FnOnce(&mut Timers) -> R) -> R {
+        TIMERS.with(|timers| function(&mut timers.borrow_mut()))
+    }
+
+    /// Wake the tasks of the timers expired at `now`.
+    ///
+    /// # Parameters
+    ///
+    /// - `now`: The current instant.
+    /// - `connections`: The buffer receiving the tokens of the connections whose
+    /// deadline is exceeded.
+    pub fn fire(&mut self, now: Instant, connections: &mut Vec<u64>) {
+        self.expire(now, |expiry| match expiry {
+            Expiry::Wake(waker) => waker.wake(),
+            Expiry::Connection(token) => connections.push(token),
+        });
+    }
+}
+
+/// Wait the `duration` without blocking the thread.
+///
+/// The future must be awaited in a task of the reactor, like in an
+/// [`AsyncListener`](crate::requests::AsyncListener).
+///
+/// # Examples
+///
+/// ```rust
+/// use std::time::Duration;
+///
+/// use crate::reactor::sleep;
+///
+/// async fn slow() {
+///     sleep(Duration::from_secs(5)).await;
+/// }
+/// ```
+pub fn sleep(duration: Duration) -> Sleep {
+    Sleep {
+        deadline: Instant::now() + duration,
+        timer: None,
+    }
+}
+
+/// The future returned by [`sleep()`].
+#[derive(Debug)]
+#[must_use = "A sleep does nothing until it is awaited"]
+pub struct Sleep {
+    #[doc(hidden)]
+    deadline: Instant,
+    #[doc(hidden)]
+    timer: Option<TimerId>,
+}
+
+impl Future for Sleep {
+    type Output = ();
+
+    /// # Panics
+    ///
+    /// - If no reactor fires the timers of the current thread.
+    fn poll(mut self: Pin<&mut Self>, context: &mut Context<'_>) -> Poll<()> {
+        assert!(
+            Timers::is_driven(),
+            "A sleep must be awaited in a task of the reactor",
+        );
+
+        if Instant::now() >= self.deadline {
+            if let Some(timer) = self.timer.take() {
+                Timers::with_current(|timers| timers.cancel(timer));
+            }
+            return Poll::Ready(());
+        }
+
+        let deadline = self.deadline;
+        let timer = self.timer;
+        self.timer = Some(Timers::with_current(|timers| {
+            match timer.and_then(|timer| timers.get_mut(timer).map(|expiry| (timer, expiry))) {
+                Some((timer, Expiry::Wake(waker))) => {
+                    waker.clone_from(context.waker());
+                    timer
+                }
+                _ => timers.insert(deadline, Expiry::Wake(context.waker().clone())),
+            }
+        }));
+
+        Poll::Pending
+    }
+}
+
+impl Drop for Sleep {
+    fn drop(&mut self) {
+        if let Some(timer) = self.timer {
+            // The timers are destroyed first at the end of the thread.
+            let _ = TIMERS.try_with(|timers| timers.borrow_mut().cancel(timer));
+        }
+    }
+}
+
+/// Wait the `future` at most the `duration`, without blocking the thread.
+///
+/// The future must be awaited in a task of the reactor, like [`sleep()`].
+/// If the duration is exceeded, the `future` is dropped.
+///
+/// # Examples
+///
+/// ```rust
+/// use std::time::Duration;
+///
+/// use crate::reactor::{sleep, timeout};
+///
+/// async fn slow() {
+///     let slow = Box::pin(sleep(Duration::from_secs(5)));
+///
+///     assert_eq!(timeout(Duration::from_secs(1), slow).await, None);
+/// }
+/// ```
+pub fn timeout<F: Future + Unpin>(duration: Duration, future: F) -> Timeout<F> {
+    Timeout {
+        future,
+        sleep: sleep(duration),
+    }
+}
+
+/// The future returned by [`timeout()`].
+///
+/// It returns the output of its future, or [`None`] if the duration is exceeded.
+#[derive(Debug)]
+#[must_use = "A timeout does nothing until it is awaited"]
+pub struct Timeout<F> {
+    #[doc(hidden)]
+    future: F,
+    #[doc(hidden)]
+    sleep: Sleep,
+}
+
+impl<F: Future + Unpin> Future for Timeout<F> {
+    type Output = Option<F::Output>;
+
+    /// # Panics
+    ///
+    /// - If no reactor fires the timers of the current thread.
+    fn poll(mut self: Pin<&mut Self>, context: &mut Context<'_>) -> Poll<Self::Output> {
+        if let Poll::Ready(output) = Pin::new(&mut self.future).poll(context) {
+            return Poll::Ready(Some(output));
+        }
+
+        Pin::new(&mut self.sleep).poll(context).map(|()| None)
+    }
+}
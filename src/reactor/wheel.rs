@@ -0,0 +1,425 @@
+use std::time::{Duration, Instant};
+
+/// The identifier of a timer in a [`TimerWheel`], to cancel it.
+///
+/// It contains the index of the timer and its generation, so the identifier of
+/// an expired or cancelled timer never refers to a new timer.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct TimerId {
+    #[doc(hidden)]
+    index: u32,
+    #[doc(hidden)]
+    generation: u32,
+}
+
+/// A hierarchical timer wheel, holding a value per timer until its deadline.
+///
+/// The wheel has [`LEVELS`](TimerWheel::LEVELS) levels of 64 slots. A slot of
+/// the level 0 lasts 1 millisecond, and a slot of each next level lasts 64 times
+/// longer. A timer is put in the slot of its deadline on the finest level which
+/// contains it. When the time reaches a slot of an upper level, its timers are
+/// moved to the lower levels, so each timer is moved at most once per level.
+///
+/// The insertion and the cancellation are in `O(1)`: a cancelled timer is only
+/// marked as free, and is skipped when its slot is reached.
+///
+/// # How to use it?
+///
+/// ```rust
+/// use std::time::{Duration, Instant};
+///
+/// use crate::reactor::wheel::TimerWheel;
+///
+/// let mut wheel = TimerWheel::new(Instant::now());
+///
+/// let first = wheel.insert(Instant::now() + Duration::from_millis(5), "first");
+/// let second = wheel.insert(Instant::now() + Duration::from_secs(60), "second");
+/// wheel.cancel(second);
+///
+/// std::thread::sleep(Duration::from_millis(5));
+///
+/// let mut expired = Vec::new();
+/// wheel.expire(Instant::now(), |value| expired.push(value));
+/// assert_eq!(expired, ["first"]);
+/// ```
+#[derive(Debug)]
+pub struct TimerWheel<T> {
+    #[doc(hidden)]
+    origin: Instant,
+    #[doc(hidden)]
+    elapsed: u64,
+    #[doc(hidden)]
+    levels: Vec<Level>,
+    #[doc(hidden)]
+    entries: Vec<Entry<T>>,
+    #[doc(hidden)]
+    free: Vec<u32>,
+}
+
+impl<T> TimerWheel<T> {
+    /// The amount of levels. The wheel contains the deadlines until
+    /// `64^LEVELS` milliseconds, about 2 years, the later ones are delayed.
+    pub const LEVELS: usize = 6;
+
+    /// The amount of slots per level, a power of 2.
+    #[doc(hidden)]
+    const SLOTS: usize = 64;
+
+    /// The amount of bits of the index of a slot.
+    #[doc(hidden)]
+    const SLOT_BITS: u32 = Self::SLOTS.trailing_zeros();
+
+    /// The duration of a tick, the slots of the level 0.
+    #[doc(hidden)]
+    const TICK: Duration = Duration::from_millis(1);
+
+    /// Create the wheel, with its time starting at `origin`.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`TimerWheel`].
+    pub fn new(origin: Instant) -> TimerWheel<T> {
+        Self {
+            origin,
+            elapsed: 0,
+            levels: (0..Self::LEVELS).map(|_| Level::default()).collect(),
+            entries: Vec::new(),
+            free: Vec::new(),
+        }
+    }
+
+    /// Add a timer holding the `value` until the `deadline`.
+    ///
+    /// The deadline is rounded up to the next millisecond, so the timer never
+    /// expires before it. A past deadline expires on the next
+    /// [`TimerWheel::expire()`].
+    ///
+    /// # Returns
+    ///
+    /// Returns the identifier of the timer.
+    pub fn insert(&mut self, deadline: Instant, value: T) -> TimerId {
+        let when = self.ticks_ceil(deadline).max(self.elapsed + 1);
+
+        let index = match self.free.pop() {
+            Some(index) => {
+                let entry = &mut self.entries[index as usize];
+                entry.when = when;
+                entry.value = Some(value);
+                index
+            }
+            None => {
+                self.entries.push(Entry {
+                    when,
+                    generation: 0,
+                    value: Some(value),
+                });
+                (self.entries.len() - 1) as u32
+            }
+        };
+
+        let id = TimerId {
+            index,
+            generation: self.entries[index as usize].generation,
+        };
+        self.schedule(id, when);
+
+        id
+    }
+
+    /// Get the value of the timer `id`, if it is not expired nor cancelled.
+    pub fn get_mut(&mut self, id: TimerId) -> Option<&mut T> {
+        self.entries
+            .get_mut(id.index as usize)
+            .filter(|entry| entry.generation == id.generation)
+            .and_then(|entry| entry.value.as_mut())
+    }
+
+    /// Cancel the timer `id`.
+    ///
+    /// # Returns
+    ///
+    /// Returns the value of the timer, or [`None`] if it is expired or already
+    /// cancelled.
+    pub fn cancel(&mut self, id: TimerId) -> Option<T> {
+        let entry = self
+            .entries
+            .get_mut(id.index as usize)
+            .filter(|entry| entry.generation == id.generation)?;
+
+        let value = entry.value.take();
+        entry.generation = entry.generation.wrapping_add(1);
+        self.free.push(id.index);
+
+        value
+    }
+
+    /// Get the instant of the next slot containing timers.
+    ///
+    /// The slot of an upper level is reached before the deadlines of its timers,
+    /// to move them to the lower levels. So, the returned instant is never after
+    /// the next deadline, but can be before it.
+    pub fn next_deadline(&self) -> Option<Instant> {
+        self.next_slot().map(|(.., tick)| {
+            self.origin + Duration::from_nanos(tick * Self::TICK.as_nanos() as u64)
+        })
+    }
+
+    /// Expire the timers whose deadline is reached at `now`, and give their
+    /// value to `expired`, in the order of their deadlines.
+    pub fn expire(&mut self, now: Instant, mut expired: impl FnMut(T)) {
+        let now = self.ticks_floor(now);
+
+        while let Some((level, slot, tick)) = self.next_slot().filter(|(.., tick)| *tick <= now) {
+            self.elapsed = tick;
+
+            let mut ids = std::mem::take(&mut self.levels[level].slots[slot]);
+            self.levels[level].occupied &= !(1 << slot);
+
+            for id in ids.drain(..) {
+                let entry = &self.entries[id.index as usize];
+                if entry.generation != id.generation {
+                    // A cancelled timer.
+                    continue;
+                }
+                let when = entry.when;
+
+                if when <= self.elapsed {
+                    expired(self.cancel(id).expect("The timer is alive"));
+                } else {
+                    self.schedule(id, when);
+                }
+            }
+
+            // Keep the allocation of the slot.
+            if self.levels[level].slots[slot].is_empty() {
+                self.levels[level].slots[slot] = ids;
+            }
+        }
+
+        self.elapsed = self.elapsed.max(now);
+    }
+
+    /// Put the timer `id` in the slot of `when`, on the finest level containing
+    /// it.
+    #[doc(hidden)]
+    fn schedule(&mut self, id: TimerId, when: u64) {
+        let bits = Self::SLOT_BITS * Self::LEVELS as u32;
+        // The later deadlines wait on the last slot of the wheel. At the last tick
+        // of the wheel, they wait on the first slot of its next turn instead, else
+        // they would be put back in the current slot.
+        let when = when.min((self.elapsed | ((1 << bits) - 1)).max(self.elapsed + 1));
+
+        let significant = 63 - ((self.elapsed ^ when) | (Self::SLOTS as u64 - 1)).leading_zeros();
+        let level = ((significant / Self::SLOT_BITS) as usize).min(Self::LEVELS - 1);
+        let slot = ((when >> (level as u32 * Self::SLOT_BITS)) as usize) & (Self::SLOTS - 1);
+
+        self.levels[level].slots[slot].push(id);
+        self.levels[level].occupied |= 1 << slot;
+    }
+
+    /// Get the next slot containing timers, with its level, its index and the
+    /// tick of its start.
+    #[doc(hidden)]
+    fn next_slot(&self) -> Option<(usize, usize, u64)> {
+        self.levels
+            .iter()
+            .enumerate()
+            .filter(|(_, level)| level.occupied != 0)
+            .map(|(index, level)| {
+                let shift = index as u32 * Self::SLOT_BITS;
+                let current = ((self.elapsed >> shift) as usize) & (Self::SLOTS - 1);
+
+                let distance = level.occupied.rotate_right(current as u32).trailing_zeros();
+                let slot = (current + distance as usize) & (Self::SLOTS - 1);
+
+                let level_range = 1u64 << (shift + Self::SLOT_BITS);
+                let start = (self.elapsed & !(level_range - 1)) + ((slot as u64) << shift);
+                let start = if start < self.elapsed {
+                    start + level_range
+                } else {
+                    start
+                };
+
+                (index, slot, start)
+            })
+            .min_by_key(|(.., start)| *start)
+    }
+
+    /// Convert the `instant` in ticks since the origin, rounded down.
+    #[doc(hidden)]
+    fn ticks_floor(&self, instant: Instant) -> u64 {
+        let elapsed = instant.saturating_duration_since(self.origin);
+        (elapsed.as_nanos() / Self::TICK.as_nanos()) as u64
+    }
+
+    /// Convert the `instant` in ticks since the origin, rounded up.
+    #[doc(hidden)]
+    fn ticks_ceil(&self, instant: Instant) -> u64 {
+        let elapsed = instant.saturating_duration_since(self.origin);
+        elapsed.as_nanos().div_ceil(Self::TICK.as_nanos()) as u64
+    }
+}
+
+/// A level of the [`TimerWheel`].
+#[derive(Debug)]
+#[doc(hidden)]
+struct Level {
+    /// The bit `i` is set if the slot `i` contains timers.
+    #[doc(hidden)]
+    occupied: u64,
+    #[doc(hidden)]
+    slots: Vec<Vec<TimerId>>,
+}
+
+impl Default for Level {
+    fn default() -> Self {
+        Self {
+            occupied: 0,
+            slots: (0..u64::BITS).map(|_| Vec::new()).collect(),
+        }
+    }
+}
+
+/// A timer of the [`TimerWheel`], free if it has no value.
+#[derive(Debug)]
+#[doc(hidden)]
+struct Entry<T> {
+    #[doc(hidden)]
+    when: u64,
+    #[doc(hidden)]
+    generation: u32,
+    #[doc(hidden)]
+    value: Option<T>,
+}
+
+#[cfg(test)]
+mod tests {
+    use std::time::{Duration, Instant};
+
+    use super::TimerWheel;
+
+    /// Get the instant `millis` milliseconds after the `origin`.
+    fn at(origin: Instant, millis: u64) -> Instant {
+        origin + Duration::from_millis(millis)
+    }
+
+    /// Expire the timers of the `wheel` at `millis`, and collect their values.
+    fn expire<T>(wheel: &mut TimerWheel<T>, origin: Instant, millis: u64) -> Vec<T> {
+        let mut expired = Vec::new();
+        wheel.expire(at(origin, millis), |value| expired.push(value));
+        expired
+    }
+
+    #[test]
+    fn expire_at_the_deadline() {
+        let origin = Instant::now();
+        let mut wheel = TimerWheel::new(origin);
+        wheel.insert(at(origin, 5), "first");
+
+        assert!(expire(&mut wheel, origin, 4).is_empty());
+        assert_eq!(expire(&mut wheel, origin, 5), ["first"]);
+        assert!(expire(&mut wheel, origin, 100).is_empty());
+        assert_eq!(wheel.next_deadline(), None);
+    }
+
+    #[test]
+    fn expire_a_past_deadline_at_the_next_expiration() {
+        let origin = Instant::now();
+        let mut wheel = TimerWheel::new(origin);
+        expire(&mut wheel, origin, 10);
+
+        wheel.insert(at(origin, 3), "late");
+        assert_eq!(expire(&mut wheel, origin, 11), ["late"]);
+    }
+
+    #[test]
+    fn cancel_a_timer() {
+        let origin = Instant::now();
+        let mut wheel = TimerWheel::new(origin);
+        let cancelled = wheel.insert(at(origin, 5), "cancelled");
+        wheel.insert(at(origin, 5), "kept");
+
+        assert_eq!(wheel.cancel(cancelled), Some("cancelled"));
+        assert_eq!(wheel.cancel(cancelled), None);
+        assert_eq!(wheel.get_mut(cancelled), None);
+        assert_eq!(expire(&mut wheel, origin, 5), ["kept"]);
+    }
+
+    #[test]
+    fn ignore_the_identifier_of_a_reused_timer() {
+        let origin = Instant::now();
+        let mut wheel = TimerWheel::new(origin);
+        let old = wheel.insert(at(origin, 5), "old");
+        wheel.cancel(old);
+
+        let new = wheel.insert(at(origin, 7), "new");
+        assert_ne!(old, new);
+        assert_eq!(wheel.cancel(old), None);
+        assert_eq!(wheel.get_mut(new), Some(&mut "new"));
+        assert_eq!(expire(&mut wheel, origin, 7), ["new"]);
+    }
+
+    #[test]
+    fn cascade_through_the_levels() {
+        let origin = Instant::now();
+        let mut wheel = TimerWheel::new(origin);
+
+        // One deadline per level, from the level 0 to the level 3.
+        let deadlines = [40, 3_000, 200_000, 10_000_000];
+        for (index, deadline) in deadlines.iter().enumerate() {
+            wheel.insert(at(origin, *deadline), index);
+        }
+
+        for (index, deadline) in deadlines.iter().enumerate() {
+            let next = wheel.next_deadline().expect("A timer remains");
+            assert!(next <= at(origin, *deadline));
+
+            assert!(expire(&mut wheel, origin, deadline - 1).is_empty());
+            assert_eq!(expire(&mut wheel, origin, *deadline), [index]);
+        }
+        assert_eq!(wheel.next_deadline(), None);
+    }
+
+    #[test]
+    fn expire_in_the_order_of_the_deadlines() {
+        let origin = Instant::now();
+        let mut wheel = TimerWheel::new(origin);
+
+        // Deadlines spread on the levels 0 to 3, by a linear congruential generator.
+        let mut seed = 42u64;
+        let mut deadlines = Vec::new();
+        for _ in 0..1_000 {
+            seed = seed
+                .wrapping_mul(6_364_136_223_846_793_005)
+                .wrapping_add(1_442_695_040_888_963_407);
+            let deadline = 1 + (seed >> 33) % 1_000_000;
+            wheel.insert(at(origin, deadline), deadline);
+            deadlines.push(deadline);
+        }
+        deadlines.sort_unstable();
+
+        let mut expired = Vec::new();
+        let mut now = 0;
+        while let Some(next) = wheel.next_deadline() {
+            now = now.max(next.duration_since(origin).as_millis() as u64);
+            wheel.expire(at(origin, now), |deadline| {
+                assert!(deadline <= now, "Expired at {now} before {deadline}");
+                expired.push(deadline);
+            });
+        }
+
+        assert_eq!(expired, deadlines);
+    }
+
+    #[test]
+    fn delay_the_deadlines_after_the_wheel() {
+        let origin = Instant::now();
+        let mut wheel = TimerWheel::new(origin);
+        let range = 1u64 << (6 * TimerWheel::<()>::LEVELS);
+        wheel.insert(at(origin, 2 * range), "far");
+
+        assert!(expire(&mut wheel, origin, range - 2).is_empty());
+        assert!(expire(&mut wheel, origin, 2 * range - 1).is_empty());
+        assert_eq!(expire(&mut wheel, origin, 2 * range), ["far"]);
+    }
+}
@@ -1,3 +1,10 @@
+use std::future::Future;
+use std::pin::Pin;
+
+pub use self::body::{Body, FileRegion};
+pub use self::chunked::{ChunkedWriter, Producer};
+pub use self::date::HttpDate;
+pub use self::headers::{HeaderName, HeaderValue, Headers};
 pub use self::job::Job;
 pub use self::method::Method;
 pub use self::request::Request;
@@ -12,6 +19,38 @@ use self::version::Version;
 /// Check examples of [`WebServer`](crate::server::WebServer).
 pub type HTTPListener = fn(Request) -> Response;
 
+/// Type for functions that process a [`Request`] without blocking, and return
+/// the future of its [`Response`].
+///
+/// The future is executed by the reactor of the server, so it must wait with
+/// [`sleep()`](crate::reactor::sleep) and never with [`std::thread::sleep()`].
+///
+/// # Examples
+///
+/// Check examples of [`WebServer::add_async_listener()`][add_async_listener].
+///
+/// <!-- References -->
+///
+/// [add_async_listener]: crate::server::WebServer::add_async_listener()
+pub type AsyncListener = fn(Request) -> Pin<Box<dyn Future<Output = Response> + Send>>;
+
+/// Module contains the [`Body`] of responses.
+mod body;
+
+/// Module contains the [`ChunkedWriter`] of streamed bodies.
+mod chunked;
+
+/// Module contains the cached [`HttpDate`].
+mod date;
+
+/// Module contains the [`Headers`] of responses.
+///
+/// # Errors
+///
+/// - [`InvalidHeaderError`](headers::InvalidHeaderError): Indicate that a
+/// [`HeaderName`] or a [`HeaderValue`] is created from an invalid entry.
+mod headers;
+
 /// Module contains the [`Job`] structure.
 mod job;
 
@@ -33,6 +72,9 @@ mod request;
 /// Module contains the [`Response`] structure.
 mod response;
 
+/// Module contains the socket options to coalesce the writes of a [`Response`].
+mod socket;
+
 /// Module contains the HTTP [`Status`].
 mod status;
 
@@ -0,0 +1,231 @@
+use std::fs::File;
+use std::io::{Read, Seek, SeekFrom};
+use std::path::Path;
+use std::sync::Arc;
+
+use super::Producer;
+
+/// Body of a [`Response`](super::Response).
+///
+/// The body is binary-safe: it is never validated as UTF-8, so any payload can be
+/// sent (HTML, images, fonts, wasm, …).
+///
+/// # How to create it?
+///
+/// ```rust
+/// use std::path::Path;
+/// use std::sync::Arc;
+///
+/// use crate::requests::{Body, FileRegion};
+///
+/// // Bytes shared between multiple responses, like a cached asset.
+/// let shared = Body::from(Arc::<[u8]>::from(&b"Hello, world!"[..]));
+///
+/// // Bytes owned by the response.
+/// let owned = Body::from(vec![0x00, 0x61, 0x73, 0x6D]);
+///
+/// // A region of a file, read only when the response is sent.
+/// let file = Body::from(FileRegion::open(Path::new("templates/index.html")).unwrap());
+/// ```
+///
+/// To stream a body, check examples of [`ChunkedWriter`](super::ChunkedWriter).
+#[derive(Debug)]
+pub enum Body {
+    /// Immutable bytes shared between multiple responses.
+    Shared(Arc<[u8]>),
+
+    /// Bytes owned by the response.
+    Owned(Vec<u8>),
+
+    /// A region of a file.
+    File(FileRegion),
+
+    /// A body pushed chunk by chunk by a [`Producer`].
+    Stream(Producer),
+}
+
+impl Body {
+    /// Get the length of the body.
+    ///
+    /// # Returns
+    ///
+    /// Returns the amount of bytes of the body, or [`None`] if the body is streamed.
+    pub fn len(&self) -> Option<u64> {
+        match self {
+            Self::Shared(bytes) => Some(bytes.len() as u64),
+            Self::Owned(bytes) => Some(bytes.len() as u64),
+            Self::File(region) => Some(region.length),
+            Self::Stream(_) => None,
+        }
+    }
+
+    /// Indicate if the body is empty.
+    ///
+    /// # Returns
+    ///
+    /// Returns `true` if the body has no bytes, a streamed body is never empty.
+    pub fn is_empty(&self) -> bool {
+        self.len() == Some(0)
+    }
+
+    /// Append the bytes of the file to the body.
+    ///
+    /// An empty body becomes the region of the whole file, without reading it.
+    /// Else, the body becomes owned and the file is read at the end of it.
+    ///
+    /// # Returns
+    ///
+    /// Returns the [`std::io::Error`] if an error happened during the read of the
+    /// file, else nothing.
+    ///
+    /// # Panics
+    ///
+    /// - If the body is streamed.
+    pub fn append_file(&mut self, path: impl AsRef<Path>) -> Result<(), std::io::Error> {
+        let mut region = FileRegion::open(path)?;
+
+        if self.is_empty() {
+            *self = Self::File(region);
+            return Ok(());
+        }
+
+        let mut bytes = match std::mem::take(self) {
+            Self::Shared(bytes) => bytes.to_vec(),
+            Self::Owned(bytes) => bytes,
+            Self::File(mut previous) => {
+                let mut bytes = Vec::with_capacity((previous.length + region.length) as usize);
+                previous.read_into(&mut bytes)?;
+                bytes
+            }
+            Self::Stream(_) => panic!("Cannot append a file to a streamed body."),
+        };
+
+        region.read_into(&mut bytes)?;
+        *self = Self::Owned(bytes);
+
+        Ok(())
+    }
+}
+
+impl Default for Body {
+    /// Create an empty owned body.
+    fn default() -> Self {
+        Self::Owned(Vec::new())
+    }
+}
+
+impl From<Arc<[u8]>> for Body {
+    fn from(value: Arc<[u8]>) -> Body {
+        Self::Shared(value)
+    }
+}
+
+impl From<Vec<u8>> for Body {
+    fn from(value: Vec<u8>) -> Body {
+        Self::Owned(value)
+    }
+}
+
+impl From<String> for Body {
+    fn from(value: String) -> Body {
+        Self::Owned(value.into_bytes())
+    }
+}
+
+impl From<FileRegion> for Body {
+    fn from(value: FileRegion) -> Body {
+        Self::File(value)
+    }
+}
+
+impl From<Producer> for Body {
+    fn from(value: Producer) -> Body {
+        Self::Stream(value)
+    }
+}
+
+/// A region of an opened file, sent as a [`Body`].
+///
+/// # How to create it?
+///
+/// ```rust
+/// use std::fs::File;
+/// use std::path::Path;
+///
+/// use crate::requests::FileRegion;
+///
+/// // The whole file.
+/// let whole = FileRegion::open(Path::new("templates/index.html")).unwrap();
+///
+/// // The 100 bytes after the 10th byte.
+/// let file = File::open(Path::new("templates/index.html")).unwrap();
+/// let part = FileRegion::new(file, 10, 100);
+/// ```
+#[derive(Debug)]
+pub struct FileRegion {
+    #[doc(hidden)]
+    file: File,
+    #[doc(hidden)]
+    offset: u64,
+    #[doc(hidden)]
+    length: u64,
+}
+
+impl FileRegion {
+    /// Create the region of `length` bytes, after the `offset` of the `file`.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`FileRegion`].
+    pub fn new(file: File, offset: u64, length: u64) -> FileRegion {
+        Self {
+            file,
+            offset,
+            length,
+        }
+    }
+
+    /// Open the file, and create the region of its whole content.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`FileRegion`], or the [`std::io::Error`] if the
+    /// file cannot be opened.
+    pub fn open(path: impl AsRef<Path>) -> Result<FileRegion, std::io::Error> {
+        let file = File::open(path.as_ref())?;
+        let length = file.metadata()?.len();
+
+        Ok(Self::new(file, 0, length))
+    }
+
+    /// Get the file of the region.
+    pub fn file(&self) -> &File {
+        &self.file
+    }
+
+    /// Get the position of the first byte of the region in the file.
+    pub fn offset(&self) -> u64 {
+        self.offset
+    }
+
+    /// Get the amount of bytes of the region.
+    pub fn length(&self) -> u64 {
+        self.length
+    }
+
+    /// Move the cursor of the file to the start of the region.
+    #[doc(hidden)]
+    fn seek_start(&mut self) -> std::io::Result<()> {
+        self.file.seek(SeekFrom::Start(self.offset)).map(|_| ())
+    }
+
+    /// Read the region at the end of `bytes`.
+    #[doc(hidden)]
+    fn read_into(&mut self, bytes: &mut Vec<u8>) -> std::io::Result<()> {
+        self.seek_start()?;
+        (&self.file)
+            .take(self.length)
+            .read_to_end(bytes)
+            .map(|_| ())
+    }
+}
@@ -0,0 +1,344 @@
+use std::fmt::{Debug, Formatter};
+use std::io::{ErrorKind, Write};
+
+/// Writer of a streamed body, given to the [`Producer`] of a
+/// [`Response`](super::Response).
+///
+/// The body is sent with the chunked transfer-encoding on `HTTP/1.1` and later,
+/// and as raw bytes delimited by the close of the connection on `HTTP/1`.
+///
+/// The written bytes are buffered until the buffer contains
+/// [`ChunkedWriter::CHUNK_SIZE`] bytes, or until [`ChunkedWriter::flush()`] is
+/// called. So, the memory cost of the body is one chunk.
+///
+/// The writer waits that the connection can accept the chunk before returning,
+/// so the producer is slowed down to the speed of the client.
+///
+/// Once a write fails, like when the client closes the connection, the writer
+/// returns the same error for all next writes, and never sends the last chunk:
+/// the client sees a truncated body instead of a complete one.
+///
+/// # How to use it?
+///
+/// ```rust
+/// use std::io::Write;
+///
+/// use crate::requests::{Request, Response, Status};
+///
+/// fn report(request: Request) -> Response {
+///     let mut response = Response::from((request, Status::Ok));
+///     response.stream(|writer| {
+///         for line in 0..100_000 {
+///             writeln!(writer, "Line {line}")?;
+///         }
+///
+///         writer.flush()
+///     });
+///
+///     response
+/// }
+/// ```
+pub struct ChunkedWriter<'a> {
+    #[doc(hidden)]
+    stream: &'a mut dyn Write,
+    #[doc(hidden)]
+    chunked: bool,
+    #[doc(hidden)]
+    buffer: Vec<u8>,
+    /// The kind of the first error of the stream.
+    #[doc(hidden)]
+    failed: Option<ErrorKind>,
+}
+
+impl<'a> ChunkedWriter<'a> {
+    /// The amount of buffered bytes before sending a chunk.
+    pub const CHUNK_SIZE: usize = 16 * 1024;
+
+    /// Space reserved before the data of the chunk, for its size line.
+    #[doc(hidden)]
+    const PREFIX_SIZE: usize = 2 * std::mem::size_of::<usize>() + 2;
+
+    /// Create the writer for the `stream`.
+    ///
+    /// # Parameters
+    ///
+    /// - `stream`: The connection on which the head of the response is already
+    /// sent.
+    /// - `chunked`: Send the body with the chunked transfer-encoding.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`ChunkedWriter`].
+    pub fn new(stream: &'a mut dyn Write, chunked: bool) -> ChunkedWriter<'a> {
+        let mut buffer = Vec::with_capacity(Self::PREFIX_SIZE + Self::CHUNK_SIZE + 2);
+        buffer.resize(Self::PREFIX_SIZE, 0);
+
+        Self {
+            stream,
+            chunked,
+            buffer,
+            failed: None,
+        }
+    }
+
+    /// Send the last chunk, to indicate the end of the body.
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the stream, or nothing if all is good.
+    pub fn finish(mut self) -> std::io::Result<()> {
+        self.send_chunk()?;
+
+        if self.chunked {
+            let result = self.stream.write_all(b"0\r\n\r\n");
+            self.latch(result)?;
+        }
+
+        self.stream.flush()
+    }
+
+    /// Keep the error of the `result` of a write, for the next writes.
+    ///
+    /// # Returns
+    ///
+    /// Returns the `result`.
+    #[doc(hidden)]
+    fn latch(&mut self, result: std::io::Result<()>) -> std::io::Result<()> {
+        if let Err(error) = &result {
+            self.failed = Some(error.kind());
+        }
+
+        result
+    }
+
+    /// Check that no previous write failed.
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the previous write, or nothing if all is good.
+    #[doc(hidden)]
+    fn check(&self) -> std::io::Result<()> {
+        match self.failed {
+            Some(kind) => Err(kind.into()),
+            None => Ok(()),
+        }
+    }
+
+    /// Send the buffered bytes as one chunk.
+    ///
+    /// The size line is written at the end of the reserved prefix, to send the
+    /// chunk with only one write.
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the stream, or nothing if all is good.
+    #[doc(hidden)]
+    fn send_chunk(&mut self) -> std::io::Result<()> {
+        self.check()?;
+
+        let length = self.buffer.len() - Self::PREFIX_SIZE;
+        if length == 0 {
+            return Ok(());
+        }
+
+        let start = if self.chunked {
+            let size_line = format!("{length:X}\r\n");
+            let start = Self::PREFIX_SIZE - size_line.len();
+            self.buffer[start..Self::PREFIX_SIZE].copy_from_slice(size_line.as_bytes());
+            self.buffer.extend_from_slice(b"\r\n");
+
+            start
+        } else {
+            Self::PREFIX_SIZE
+        };
+
+        let result = self.stream.write_all(&self.buffer[start..]);
+        self.buffer.truncate(Self::PREFIX_SIZE);
+
+        self.latch(result)
+    }
+}
+
+impl Write for ChunkedWriter<'_> {
+    /// Buffer the bytes, and send a chunk if the buffer is full.
+    fn write(&mut self, buf: &[u8]) -> std::io::Result<usize> {
+        self.check()?;
+
+        let available = Self::PREFIX_SIZE + Self::CHUNK_SIZE - self.buffer.len();
+        let written = buf.len().min(available);
+        self.buffer.extend_from_slice(&buf[..written]);
+
+        if written == available {
+            self.send_chunk()?;
+        }
+
+        Ok(written)
+    }
+
+    /// Send the buffered bytes as one chunk, even if the buffer is not full.
+    fn flush(&mut self) -> std::io::Result<()> {
+        self.send_chunk()?;
+        self.stream.flush()
+    }
+}
+
+impl Debug for ChunkedWriter<'_> {
+    fn fmt(&self, f: &mut Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("ChunkedWriter")
+            .field("chunked", &self.chunked)
+            .field("failed", &self.failed)
+            .field("buffered", &(self.buffer.len() - Self::PREFIX_SIZE))
+            .finish()
+    }
+}
+
+/// Function that pushes the body of a streamed [`Response`](super::Response) into
+/// the [`ChunkedWriter`].
+///
+/// # How to create it?
+///
+/// Check examples of [`ChunkedWriter`].
+pub struct Producer {
+    #[doc(hidden)]
+    function: Box<dyn FnOnce(&mut ChunkedWriter<'_>) -> std::io::Result<()> + Send>,
+}
+
+impl Producer {
+    /// Call the function with the `writer`.
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the function, or nothing if all is good.
+    pub fn produce(self, writer: &mut ChunkedWriter<'_>) -> std::io::Result<()> {
+        (self.function)(writer)
+    }
+}
+
+impl<F> From<F> for Producer
+where
+    F: FnOnce(&mut ChunkedWriter<'_>) -> std::io::Result<()> + Send + 'static,
+{
+    /// Create a [`Producer`] from the function.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Producer`].
+    fn from(value: F) -> Producer {
+        Self {
+            function: Box::new(value),
+        }
+    }
+}
+
+impl Debug for Producer {
+    fn fmt(&self, f: &mut Formatter<'_>) -> std::fmt::Result {
+        f.write_str("Producer")
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use std::io::{ErrorKind, Write};
+
+    use super::ChunkedWriter;
+
+    /// A stream failing all writes after `accepted` writes, recording the
+    /// accepted bytes.
+    struct Failing {
+        accepted: usize,
+        bytes: Vec<u8>,
+    }
+
+    impl Write for Failing {
+        fn write(&mut self, buf: &[u8]) -> std::io::Result<usize> {
+            if self.accepted == 0 {
+                return Err(ErrorKind::BrokenPipe.into());
+            }
+
+            self.accepted -= 1;
+            self.bytes.extend_from_slice(buf);
+            Ok(buf.len())
+        }
+
+        fn flush(&mut self) -> std::io::Result<()> {
+            Ok(())
+        }
+    }
+
+    #[test]
+    fn frame_the_chunks() {
+        let mut stream = Vec::new();
+        let mut writer = ChunkedWriter::new(&mut stream, true);
+
+        writer.write_all(b"Hello").unwrap();
+        writer.flush().unwrap();
+        writer.write_all(b", world!").unwrap();
+        writer.finish().unwrap();
+
+        assert_eq!(stream, b"5\r\nHello\r\n8\r\n, world!\r\n0\r\n\r\n");
+    }
+
+    #[test]
+    fn split_the_chunks_at_the_chunk_size() {
+        let body = vec![b'a'; ChunkedWriter::CHUNK_SIZE + 10];
+        let mut stream = Vec::new();
+        let mut writer = ChunkedWriter::new(&mut stream, true);
+
+        writer.write_all(&body).unwrap();
+        writer.finish().unwrap();
+
+        let mut expected = format!("{:X}\r\n", ChunkedWriter::CHUNK_SIZE).into_bytes();
+        expected.extend_from_slice(&body[..ChunkedWriter::CHUNK_SIZE]);
+        expected.extend_from_slice(b"\r\nA\r\naaaaaaaaaa\r\n0\r\n\r\n");
+        assert_eq!(stream, expected);
+    }
+
+    #[test]
+    fn send_no_empty_chunk() {
+        let mut stream = Vec::new();
+        let mut writer = ChunkedWriter::new(&mut stream, true);
+
+        writer.flush().unwrap();
+        writer.write_all(b"").unwrap();
+        writer.finish().unwrap();
+
+        assert_eq!(stream, b"0\r\n\r\n");
+    }
+
+    #[test]
+    fn send_the_raw_bytes_without_chunked_encoding() {
+        let mut stream = Vec::new();
+        let mut writer = ChunkedWriter::new(&mut stream, false);
+
+        writer.write_all(b"Hello").unwrap();
+        writer.flush().unwrap();
+        writer.write_all(b", world!").unwrap();
+        writer.finish().unwrap();
+
+        assert_eq!(stream, b"Hello, world!");
+    }
+
+    #[test]
+    fn keep_the_first_error() {
+        let mut stream = Failing {
+            accepted: 1,
+            bytes: Vec::new(),
+        };
+        let mut writer = ChunkedWriter::new(&mut stream, true);
+
+        writer.write_all(b"sent").unwrap();
+        writer.flush().unwrap();
+        writer.write_all(b"lost").unwrap();
+
+        let error = writer.flush().unwrap_err();
+        assert_eq!(error.kind(), ErrorKind::BrokenPipe);
+        assert_eq!(
+            writer.write(b"next").unwrap_err().kind(),
+            ErrorKind::BrokenPipe
+        );
+        assert_eq!(writer.finish().unwrap_err().kind(), ErrorKind::BrokenPipe);
+
+        // The last chunk is never sent, so the client sees a truncated body.
+        assert_eq!(stream.bytes, b"4\r\nsent\r\n");
+    }
+}
@@ -0,0 +1,269 @@
+use std::fmt::{Display, Formatter};
+use std::sync::atomic::{fence, AtomicU64, AtomicUsize, Ordering};
+use std::sync::Once;
+use std::thread::{sleep, Builder};
+use std::time::{Duration, SystemTime, UNIX_EPOCH};
+
+/// The HTTP date of the current second, in the IMF-fixdate format of the
+/// [RFC 7231](https://www.rfc-editor.org/rfc/rfc7231#section-7.1.1.1).
+///
+/// The date is formatted once per second by a clock thread, and stored in a global
+/// cell. Reading it copies 29 bytes, without any lock, nor call to the system clock.
+///
+/// # How to use it?
+///
+/// ```rust
+/// use crate::requests::HttpDate;
+///
+/// let date = HttpDate::now();
+///
+/// // Like: "Sun, 06 Nov 1994 08:49:37 GMT"
+/// println!("Date: {date}");
+/// ```
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct HttpDate {
+    #[doc(hidden)]
+    bytes: [u8; HttpDate::LENGTH],
+}
+
+impl HttpDate {
+    /// The length of a formatted date, like `Sun, 06 Nov 1994 08:49:37 GMT`.
+    pub const LENGTH: usize = 29;
+
+    /// Get the date of the current second.
+    ///
+    /// The first call starts the clock thread.
+    ///
+    /// # Returns
+    ///
+    /// Returns the cached [`HttpDate`], updated at most one second ago.
+    ///
+    /// # Panics
+    ///
+    /// - If the spawn of the clock thread returns an error.
+    pub fn now() -> HttpDate {
+        CLOCK.call_once(|| {
+            CELL.store(&Self::format(SystemTime::now()));
+
+            Builder::new()
+                .name(String::from("Clock"))
+                .spawn(|| loop {
+                    let now = SystemTime::now();
+                    CELL.store(&Self::format(now));
+
+                    let elapsed = now.duration_since(UNIX_EPOCH).unwrap_or_default();
+                    sleep(Duration::from_nanos(
+                        1_000_000_000 - u64::from(elapsed.subsec_nanos()),
+                    ));
+                })
+                .expect("Cannot spawn the clock thread.");
+        });
+
+        Self { bytes: CELL.load() }
+    }
+
+    /// Get the formatted date as bytes.
+    pub fn as_bytes(&self) -> &[u8] {
+        &self.bytes
+    }
+
+    /// Format the `time` in the IMF-fixdate format.
+    ///
+    /// # Returns
+    ///
+    /// Returns the 29 bytes of the date, like `Sun, 06 Nov 1994 08:49:37 GMT`.
+    #[doc(hidden)]
+    fn format(time: SystemTime) -> [u8; HttpDate::LENGTH] {
+        const DAYS: [&[u8; 3]; 7] = [b"Thu", b"Fri", b"Sat", b"Sun", b"Mon", b"Tue", b"Wed"];
+        const MONTHS: [&[u8; 3]; 12] = [
+            b"Jan", b"Feb", b"Mar", b"Apr", b"May", b"Jun", b"Jul", b"Aug", b"Sep", b"Oct", b"Nov",
+            b"Dec",
+        ];
+
+        let seconds = time
+            .duration_since(UNIX_EPOCH)
+            .unwrap_or_default()
+            .as_secs();
+        let days = seconds / 86_400;
+        let seconds_of_day = seconds % 86_400;
+
+        // Civil date from the days since the epoch, cf. Howard Hinnant's algorithm.
+        let shifted = days + 719_468;
+        let era = shifted / 146_097;
+        let day_of_era = shifted % 146_097;
+        let year_of_era =
+            (day_of_era - day_of_era / 1_460 + day_of_era / 36_524 - day_of_era / 146_096) / 365;
+        let day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+        let shifted_month = (5 * day_of_year + 2) / 153;
+        let day = day_of_year - (153 * shifted_month + 2) / 5 + 1;
+        let month = if shifted_month < 10 {
+            shifted_month + 3
+        } else {
+            shifted_month - 9
+        };
+        let year = year_of_era + era * 400 + u64::from(month <= 2);
+
+        let digit = |value: u64| b'0' + (value % 10) as u8;
+
+        let mut bytes = *b"Thu, 01 Jan 1970 00:00:00 GMT";
+        bytes[..3].copy_from_slice(DAYS[(days % 7) as usize]);
+        bytes[5] = digit(day / 10);
+        bytes[6] = digit(day);
+        bytes[8..11].copy_from_slice(MONTHS[(month - 1) as usize]);
+        bytes[12] = digit(year / 1_000);
+        bytes[13] = digit(year / 100);
+        bytes[14] = digit(year / 10);
+        bytes[15] = digit(year);
+        bytes[17] = digit(seconds_of_day / 36_000);
+        bytes[18] = digit(seconds_of_day / 3_600);
+        bytes[20] = digit(seconds_of_day % 3_600 / 600);
+        bytes[21] = digit(seconds_of_day % 3_600 / 60);
+        bytes[23] = digit(seconds_of_day % 60 / 10);
+        bytes[24] = digit(seconds_of_day % 60);
+
+        bytes
+    }
+}
+
+impl Display for HttpDate {
+    fn fmt(&self, f: &mut Formatter<'_>) -> std::fmt::Result {
+        f.write_str(std::str::from_utf8(&self.bytes).map_err(|_| std::fmt::Error)?)
+    }
+}
+
+/// Global cell containing the formatted date, written by the clock thread only.
+///
+/// It is a sequence lock: the writer makes the sequence odd during the update,
+/// and readers retry until they read the same even sequence before and after
+/// the copy of the words.
+#[doc(hidden)]
+struct DateCell {
+    #[doc(hidden)]
+    sequence: AtomicUsize,
+    #[doc(hidden)]
+    words: [AtomicU64; DateCell::WORDS],
+}
+
+impl DateCell {
+    /// Number of words to store the 29 bytes of the date.
+    #[doc(hidden)]
+    const WORDS: usize = HttpDate::LENGTH.div_ceil(8);
+
+    #[doc(hidden)]
+    const fn new() -> DateCell {
+        Self {
+            sequence: AtomicUsize::new(0),
+            words: [
+                AtomicU64::new(0),
+                AtomicU64::new(0),
+                AtomicU64::new(0),
+                AtomicU64::new(0),
+            ],
+        }
+    }
+
+    /// Store the formatted date, must be called by only one thread at a time.
+    #[doc(hidden)]
+    fn store(&self, bytes: &[u8; HttpDate::LENGTH]) {
+        let mut padded = [0; Self::WORDS * 8];
+        padded[..HttpDate::LENGTH].copy_from_slice(bytes);
+
+        let sequence = self.sequence.load(Ordering::Relaxed);
+        self.sequence
+            .store(sequence.wrapping_add(1), Ordering::Relaxed);
+        fence(Ordering::Release);
+
+        for (word, chunk) in self.words.iter().zip(padded.chunks_exact(8)) {
+            word.store(
+                u64::from_ne_bytes(chunk.try_into().unwrap()),
+                Ordering::Relaxed,
+            );
+        }
+
+        self.sequence
+            .store(sequence.wrapping_add(2), Ordering::Release);
+    }
+
+    /// Load the formatted date, without lock.
+    #[doc(hidden)]
+    fn load(&self) -> [u8; HttpDate::LENGTH] {
+        let mut padded = [0; Self::WORDS * 8];
+
+        loop {
+            let before = self.sequence.load(Ordering::Acquire);
+            if before % 2 == 1 {
+                std::hint::spin_loop();
+                continue;
+            }
+
+            for (word, chunk) in self.words.iter().zip(padded.chunks_exact_mut(8)) {
+                chunk.copy_from_slice(&word.load(Ordering::Relaxed).to_ne_bytes());
+            }
+
+            fence(Ordering::Acquire);
+            if self.sequence.load(Ordering::Relaxed) == before {
+                break;
+            }
+        }
+
+        let mut bytes = [0; HttpDate::LENGTH];
+        bytes.copy_from_slice(&padded[..HttpDate::LENGTH]);
+        bytes
+    }
+}
+
+#[doc(hidden)]
+static CELL: DateCell = DateCell::new();
+
+#[doc(hidden)]
+static CLOCK: Once = Once::new();
+
+#[cfg(test)]
+mod tests {
+    use std::time::{Duration, UNIX_EPOCH};
+
+    use super::{DateCell, HttpDate};
+
+    /// Format the `seconds` since the epoch.
+    fn format(seconds: u64) -> String {
+        let bytes = HttpDate::format(UNIX_EPOCH + Duration::from_secs(seconds));
+        String::from_utf8(bytes.to_vec()).unwrap()
+    }
+
+    #[test]
+    fn format_known_dates() {
+        assert_eq!(format(0), "Thu, 01 Jan 1970 00:00:00 GMT");
+        assert_eq!(format(784_111_777), "Sun, 06 Nov 1994 08:49:37 GMT");
+        assert_eq!(format(1_735_689_599), "Tue, 31 Dec 2024 23:59:59 GMT");
+        assert_eq!(format(2_147_483_648), "Tue, 19 Jan 2038 03:14:08 GMT");
+    }
+
+    #[test]
+    fn format_leap_days() {
+        assert_eq!(format(951_782_400), "Tue, 29 Feb 2000 00:00:00 GMT");
+        assert_eq!(format(4_107_585_600), "Mon, 01 Mar 2100 12:00:00 GMT");
+    }
+
+    #[test]
+    fn format_before_epoch() {
+        let bytes = HttpDate::format(UNIX_EPOCH - Duration::from_secs(1));
+        assert_eq!(&bytes, b"Thu, 01 Jan 1970 00:00:00 GMT");
+    }
+
+    #[test]
+    fn cell_returns_the_stored_date() {
+        let cell = DateCell::new();
+        let date = *b"Sun, 06 Nov 1994 08:49:37 GMT";
+
+        cell.store(&date);
+        assert_eq!(cell.load(), date);
+    }
+
+    #[test]
+    fn now_is_formatted() {
+        let date = HttpDate::now().to_string();
+
+        assert_eq!(date.len(), HttpDate::LENGTH);
+        assert!(date.ends_with(" GMT"));
+    }
+}
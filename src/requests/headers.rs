@@ -0,0 +1,462 @@
+use std::borrow::Cow;
+use std::error::Error;
+use std::fmt::{Display, Formatter};
+
+/// Name of an HTTP header.
+///
+/// The common names are interned as constants, so they are never allocated.
+///
+/// # Panics
+///
+/// The creation from a literal panics if the name is not an HTTP token, like
+/// with a space, a `:` or a line break, cf.[`HeaderName::is_token()`]. The
+/// creation from a [`String`] returns an [`InvalidHeaderError`] instead.
+///
+/// # How to use it?
+///
+/// ```rust
+/// use crate::requests::HeaderName;
+///
+/// let content_type = HeaderName::CONTENT_TYPE;
+/// let custom = HeaderName::try_from(String::from("X-Request-Id")).unwrap();
+///
+/// assert_eq!(HeaderName::from("content-type"), content_type);
+/// assert!(HeaderName::try_from(String::from("X Request Id")).is_err());
+/// ```
+#[derive(Debug, Clone, Eq)]
+pub enum HeaderName {
+    /// A name known at compile time.
+    Static(&'static str),
+
+    /// A name created at runtime.
+    Owned(Box<str>),
+}
+
+impl HeaderName {
+    /// [MDN - Cache-Control](https://developer.mozilla.org/en-US/docs/Web/HTTP/Headers/Cache-Control)
+    pub const CACHE_CONTROL: Self = Self::Static("Cache-Control");
+
+    /// [MDN - Connection](https://developer.mozilla.org/en-US/docs/Web/HTTP/Headers/Connection)
+    pub const CONNECTION: Self = Self::Static("Connection");
+
+    /// [MDN - Content-Encoding](https://developer.mozilla.org/en-US/docs/Web/HTTP/Headers/Content-Encoding)
+    pub const CONTENT_ENCODING: Self = Self::Static("Content-Encoding");
+
+    /// [MDN - Content-Length](https://developer.mozilla.org/en-US/docs/Web/HTTP/Headers/Content-Length)
+    pub const CONTENT_LENGTH: Self = Self::Static("Content-Length");
+
+    /// [MDN - Content-Type](https://developer.mozilla.org/en-US/docs/Web/HTTP/Headers/Content-Type)
+    pub const CONTENT_TYPE: Self = Self::Static("Content-Type");
+
+    /// [MDN - Date](https://developer.mozilla.org/en-US/docs/Web/HTTP/Headers/Date)
+    pub const DATE: Self = Self::Static("Date");
+
+    /// [MDN - ETag](https://developer.mozilla.org/en-US/docs/Web/HTTP/Headers/ETag)
+    pub const ETAG: Self = Self::Static("ETag");
+
+    /// [MDN - Last-Modified](https://developer.mozilla.org/en-US/docs/Web/HTTP/Headers/Last-Modified)
+    pub const LAST_MODIFIED: Self = Self::Static("Last-Modified");
+
+    /// [MDN - Location](https://developer.mozilla.org/en-US/docs/Web/HTTP/Headers/Location)
+    pub const LOCATION: Self = Self::Static("Location");
+
+    /// [MDN - Retry-After](https://developer.mozilla.org/en-US/docs/Web/HTTP/Headers/Retry-After)
+    pub const RETRY_AFTER: Self = Self::Static("Retry-After");
+
+    /// [MDN - Server](https://developer.mozilla.org/en-US/docs/Web/HTTP/Headers/Server)
+    pub const SERVER: Self = Self::Static("Server");
+
+    /// [MDN - Transfer-Encoding](https://developer.mozilla.org/en-US/docs/Web/HTTP/Headers/Transfer-Encoding)
+    pub const TRANSFER_ENCODING: Self = Self::Static("Transfer-Encoding");
+
+    /// [MDN - Vary](https://developer.mozilla.org/en-US/docs/Web/HTTP/Headers/Vary)
+    pub const VARY: Self = Self::Static("Vary");
+
+    /// All interned names, used to avoid the allocation of known names.
+    #[doc(hidden)]
+    const INTERNED: &'static [Self] = &[
+        Self::CACHE_CONTROL,
+        Self::CONNECTION,
+        Self::CONTENT_ENCODING,
+        Self::CONTENT_LENGTH,
+        Self::CONTENT_TYPE,
+        Self::DATE,
+        Self::ETAG,
+        Self::LAST_MODIFIED,
+        Self::LOCATION,
+        Self::RETRY_AFTER,
+        Self::SERVER,
+        Self::TRANSFER_ENCODING,
+        Self::VARY,
+    ];
+
+    /// Get the name as a string.
+    pub fn as_str(&self) -> &str {
+        match self {
+            Self::Static(name) => name,
+            Self::Owned(name) => name,
+        }
+    }
+
+    /// Indicate if the `name` is an HTTP token, so it can be written as the name
+    /// of a header.
+    ///
+    /// [RFC 9110 - Tokens](https://www.rfc-editor.org/rfc/rfc9110#name-tokens)
+    pub fn is_token(name: &str) -> bool {
+        !name.is_empty()
+            && name
+                .bytes()
+                .all(|byte| byte.is_ascii_alphanumeric() || b"!#$%&'*+-.^_`|~".contains(&byte))
+    }
+
+    /// Check that the `name` is an HTTP token.
+    ///
+    /// # Returns
+    ///
+    /// Returns nothing if the `name` is a token, or [`InvalidHeaderError`] if
+    /// not, cf.[`HeaderName::is_token()`].
+    #[doc(hidden)]
+    fn check(name: &str) -> Result<(), InvalidHeaderError> {
+        if !Self::is_token(name) {
+            return Err(InvalidHeaderError::InvalidNameError(name.to_owned()));
+        }
+
+        Ok(())
+    }
+
+    /// Get the interned name equal to the `name`, if it exists.
+    #[doc(hidden)]
+    fn interned(name: &str) -> Option<HeaderName> {
+        Self::INTERNED
+            .iter()
+            .find(|interned| interned.as_str().eq_ignore_ascii_case(name))
+            .cloned()
+    }
+}
+
+impl PartialEq for HeaderName {
+    /// Names are case-insensitive.
+    fn eq(&self, other: &Self) -> bool {
+        self.as_str().eq_ignore_ascii_case(other.as_str())
+    }
+}
+
+impl Display for HeaderName {
+    fn fmt(&self, f: &mut Formatter<'_>) -> std::fmt::Result {
+        f.write_str(self.as_str())
+    }
+}
+
+impl From<&'static str> for HeaderName {
+    /// Get the interned name if it exists, else keep the static name.
+    ///
+    /// # Panics
+    ///
+    /// - If the literal is not a token, cf.[`HeaderName::is_token()`].
+    fn from(value: &'static str) -> HeaderName {
+        Self::check(value).unwrap_or_else(|error| panic!("{error}"));
+
+        Self::interned(value).unwrap_or(Self::Static(value))
+    }
+}
+
+impl TryFrom<String> for HeaderName {
+    type Error = InvalidHeaderError;
+
+    /// Get the interned name if it exists, else own the name.
+    ///
+    /// # Returns
+    ///
+    /// Returns the instance of [`HeaderName`], or the error if `value` is not a
+    /// token, cf.[`HeaderName::is_token()`].
+    fn try_from(value: String) -> Result<HeaderName, Self::Error> {
+        Self::check(&value)?;
+
+        Ok(Self::interned(&value).unwrap_or_else(|| Self::Owned(value.into_boxed_str())))
+    }
+}
+
+/// Value of an HTTP header, as bytes.
+///
+/// A value cannot contain `\r`, `\n` or `\0`: written in the head, it would end
+/// the header, and let a value coming from the request add headers or split the
+/// response.
+///
+/// # Panics
+///
+/// The creation from a literal panics if the value is invalid. The creation
+/// from a [`String`] or a [`Vec`] returns an [`InvalidHeaderError`] instead.
+///
+/// # How to create it?
+///
+/// ```rust
+/// use crate::requests::HeaderValue;
+///
+/// let known = HeaderValue::from("no-cache");
+/// let computed = HeaderValue::try_from(format!("\"{:x}\"", 42)).unwrap();
+///
+/// assert!(HeaderValue::try_from(String::from("a\r\nSet-Cookie: b")).is_err());
+/// ```
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct HeaderValue {
+    #[doc(hidden)]
+    bytes: Cow<'static, [u8]>,
+}
+
+impl HeaderValue {
+    /// Get the value as bytes.
+    pub fn as_bytes(&self) -> &[u8] {
+        &self.bytes
+    }
+
+    /// Create the value from the `bytes`, after checking them.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`HeaderValue`], or [`InvalidHeaderError`] if
+    /// the `bytes` contain `\r`, `\n` or `\0`.
+    #[doc(hidden)]
+    fn checked(bytes: Cow<'static, [u8]>) -> Result<HeaderValue, InvalidHeaderError> {
+        if bytes
+            .iter()
+            .any(|byte| matches!(byte, b'\r' | b'\n' | b'\0'))
+        {
+            let value = String::from_utf8_lossy(&bytes).into_owned();
+            return Err(InvalidHeaderError::InvalidValueError(value));
+        }
+
+        Ok(Self { bytes })
+    }
+
+    /// Create the value from a literal, after checking it.
+    ///
+    /// # Panics
+    ///
+    /// - If the literal contains `\r`, `\n` or `\0`.
+    #[doc(hidden)]
+    fn literal(bytes: &'static [u8]) -> HeaderValue {
+        Self::checked(Cow::Borrowed(bytes)).unwrap_or_else(|error| panic!("{error}"))
+    }
+}
+
+impl From<&'static str> for HeaderValue {
+    fn from(value: &'static str) -> HeaderValue {
+        Self::literal(value.as_bytes())
+    }
+}
+
+impl From<&'static [u8]> for HeaderValue {
+    fn from(value: &'static [u8]) -> HeaderValue {
+        Self::literal(value)
+    }
+}
+
+impl TryFrom<String> for HeaderValue {
+    type Error = InvalidHeaderError;
+
+    fn try_from(value: String) -> Result<HeaderValue, Self::Error> {
+        Self::checked(Cow::Owned(value.into_bytes()))
+    }
+}
+
+impl TryFrom<Vec<u8>> for HeaderValue {
+    type Error = InvalidHeaderError;
+
+    fn try_from(value: Vec<u8>) -> Result<HeaderValue, Self::Error> {
+        Self::checked(Cow::Owned(value))
+    }
+}
+
+/// Indicate that a [`HeaderName`] or a [`HeaderValue`] is created from an
+/// invalid entry.
+#[derive(Debug, Clone)]
+pub enum InvalidHeaderError {
+    /// Indicate that the name is not an HTTP token.
+    InvalidNameError(String),
+    /// Indicate that the value contains `\r`, `\n` or `\0`.
+    InvalidValueError(String),
+}
+
+impl Display for InvalidHeaderError {
+    fn fmt(&self, f: &mut Formatter<'_>) -> std::fmt::Result {
+        match self {
+            Self::InvalidNameError(entry) => write!(f, "Invalid header name: '{entry}'"),
+            Self::InvalidValueError(entry) => write!(f, "Invalid header value: {entry:?}"),
+        }
+    }
+}
+
+impl Error for InvalidHeaderError {}
+
+/// Headers of a [`Response`](super::Response).
+///
+/// The first [`Headers::INLINE_CAPACITY`] headers are stored inline, so the
+/// common responses never allocate their headers. The next ones are stored in
+/// a [`Vec`].
+///
+/// # How to use it?
+///
+/// ```rust
+/// use crate::requests::{HeaderName, Headers};
+///
+/// let mut headers = Headers::default();
+/// headers.insert(HeaderName::CACHE_CONTROL, "no-cache");
+/// headers.insert(HeaderName::VARY, "Accept-Encoding");
+///
+/// // Replace the previous value.
+/// headers.insert(HeaderName::CACHE_CONTROL, "max-age=3600");
+///
+/// let mut buffer = Vec::new();
+/// headers.write_to(&mut buffer);
+/// assert_eq!(buffer, b"Cache-Control: max-age=3600\r\nVary: Accept-Encoding\r\n");
+/// ```
+#[derive(Debug, Clone, Default)]
+pub struct Headers {
+    #[doc(hidden)]
+    inline: [Option<(HeaderName, HeaderValue)>; Headers::INLINE_CAPACITY],
+    #[doc(hidden)]
+    spilled: Vec<(HeaderName, HeaderValue)>,
+}
+
+impl Headers {
+    /// The amount of headers stored without allocation.
+    pub const INLINE_CAPACITY: usize = 8;
+
+    /// Insert the header, and replace the previous value of the `name`.
+    ///
+    /// # Returns
+    ///
+    /// Returns the previous value of the header, if it exists.
+    pub fn insert(
+        &mut self,
+        name: impl Into<HeaderName>,
+        value: impl Into<HeaderValue>,
+    ) -> Option<HeaderValue> {
+        let name = name.into();
+        let value = value.into();
+
+        if let Some((_, previous)) = self.iter_mut().find(|(current, _)| **current == name) {
+            return Some(std::mem::replace(previous, value));
+        }
+
+        self.append(name, value);
+        None
+    }
+
+    /// Append the header, even if the `name` already exists.
+    pub fn append(&mut self, name: impl Into<HeaderName>, value: impl Into<HeaderValue>) {
+        let header = (name.into(), value.into());
+
+        match self.inline.iter_mut().find(|slot| slot.is_none()) {
+            Some(slot) => *slot = Some(header),
+            None => self.spilled.push(header),
+        }
+    }
+
+    /// Get the first value of the header.
+    ///
+    /// # Returns
+    ///
+    /// Returns the value, or [`None`] if the header does not exist.
+    pub fn get(&self, name: &HeaderName) -> Option<&HeaderValue> {
+        self.iter()
+            .find(|(current, _)| *current == name)
+            .map(|(_, value)| value)
+    }
+
+    /// Indicate if the header exists.
+    pub fn contains(&self, name: &HeaderName) -> bool {
+        self.get(name).is_some()
+    }
+
+    /// Iterate over the headers, in the insertion order.
+    pub fn iter(&self) -> impl Iterator<Item = (&HeaderName, &HeaderValue)> {
+        self.inline
+            .iter()
+            .flatten()
+            .chain(self.spilled.iter())
+            .map(|(name, value)| (name, value))
+    }
+
+    /// Iterate over the mutable values of the headers.
+    #[doc(hidden)]
+    fn iter_mut(&mut self) -> impl Iterator<Item = (&HeaderName, &mut HeaderValue)> {
+        self.inline
+            .iter_mut()
+            .flatten()
+            .chain(self.spilled.iter_mut())
+            .map(|(name, value)| (&*name, value))
+    }
+
+    /// Serialize the headers, each one terminated by `\r\n`, at the end of the
+    /// `buffer`.
+    pub fn write_to(&self, buffer: &mut Vec<u8>) {
+        for (name, value) in self.iter() {
+            buffer.extend_from_slice(name.as_str().as_bytes());
+            buffer.extend_from_slice(b": ");
+            buffer.extend_from_slice(value.as_bytes());
+            buffer.extend_from_slice(b"\r\n");
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::{HeaderName, HeaderValue, Headers, InvalidHeaderError};
+
+    #[test]
+    fn intern_the_known_names() {
+        let name = HeaderName::try_from(String::from("content-type")).unwrap();
+
+        assert!(matches!(name, HeaderName::Static("Content-Type")));
+        assert_eq!(HeaderName::from("CONTENT-TYPE"), HeaderName::CONTENT_TYPE);
+    }
+
+    #[test]
+    fn reject_an_invalid_name() {
+        for name in ["", "X Request", "X:Request", "X\r\nRequest"] {
+            let error = HeaderName::try_from(String::from(name)).unwrap_err();
+            assert!(matches!(error, InvalidHeaderError::InvalidNameError(_)));
+        }
+    }
+
+    #[test]
+    #[should_panic(expected = "Invalid header name")]
+    fn panic_on_an_invalid_literal_name() {
+        let _ = HeaderName::from("X Request");
+    }
+
+    #[test]
+    fn reject_an_invalid_value() {
+        for value in ["a\rb", "a\nb", "a\0b"] {
+            let error = HeaderValue::try_from(String::from(value)).unwrap_err();
+            assert!(matches!(error, InvalidHeaderError::InvalidValueError(_)));
+
+            let error = HeaderValue::try_from(value.as_bytes().to_vec()).unwrap_err();
+            assert!(matches!(error, InvalidHeaderError::InvalidValueError(_)));
+        }
+
+        let value = HeaderValue::try_from(String::from("max-age=3600")).unwrap();
+        assert_eq!(value.as_bytes(), b"max-age=3600");
+    }
+
+    #[test]
+    fn spill_after_the_inline_headers() {
+        const NAMES: [&str; 10] = [
+            "X-A", "X-B", "X-C", "X-D", "X-E", "X-F", "X-G", "X-H", "X-I", "X-J",
+        ];
+
+        let mut headers = Headers::default();
+        for name in NAMES {
+            headers.insert(name, "1");
+        }
+        assert_eq!(headers.insert("x-j", "2"), Some(HeaderValue::from("1")));
+
+        let names: Vec<_> = headers.iter().map(|(name, _)| name.as_str()).collect();
+        assert_eq!(names, NAMES);
+        assert_eq!(
+            headers.get(&HeaderName::from("X-J")),
+            Some(&HeaderValue::from("2"))
+        );
+    }
+}
@@ -1,3 +1,8 @@
+use std::panic::{catch_unwind, AssertUnwindSafe};
+use std::thread::Result;
+use std::time::{Duration, Instant};
+
+use crate::logging::warning;
 use crate::requests::{HTTPListener, Request, Response};
 
 /// A transport structure for a [`Request`] and an [`HTTPListener`].
@@ -39,9 +44,30 @@ use crate::requests::{HTTPListener, Request, Response};
 pub struct Job {
     pub request: Request,
     pub listener: HTTPListener,
+    #[doc(hidden)]
+    created: Instant,
 }
 
 impl Job {
+    /// Create a [`Job`] to process the `request` with the `listener`.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Job`].
+    pub fn new(request: Request, listener: HTTPListener) -> Job {
+        Self {
+            request,
+            listener,
+            created: Instant::now(),
+        }
+    }
+
+    /// Get the duration since the creation of the [`Job`], so the time it waits in
+    /// the queue before its execution.
+    pub fn waiting_time(&self) -> Duration {
+        self.created.elapsed()
+    }
+
     /// Call the listener with the request.
     ///
     /// # Returns
@@ -55,4 +81,43 @@ impl Job {
         let listener = self.listener;
         listener(self.request)
     }
+
+    /// Call the listener with the request and send the response, without letting
+    /// a panic end the worker.
+    ///
+    /// If the [`HTTPListener`] panics, the response `500 INTERNAL SERVER ERROR` is
+    /// sent if possible. If the send of the response fails or panics, the
+    /// connection is closed.
+    ///
+    /// A panic after the cancellation of the request, when the client closed the
+    /// connection, is not an error.
+    ///
+    /// # Returns
+    ///
+    /// Returns the payload of the panic, or nothing if all is good.
+    pub fn run(self) -> Result<()> {
+        // The request is consumed by the listener, and its stream is closed
+        // during the unwinding, so a duplicate is kept to report the error.
+        let stream = self.request.try_clone_stream().ok();
+        let cancellation = self.request.cancellation();
+
+        let mut response = match catch_unwind(AssertUnwindSafe(|| self.execute())) {
+            Ok(response) => response,
+            Err(_) if cancellation.is_cancelled() => return Ok(()),
+            Err(panic) => {
+                if let Some(stream) = stream {
+                    let _ = Response::reject_internal_error(stream);
+                }
+                return Err(panic);
+            }
+        };
+        drop(stream);
+
+        let sent = catch_unwind(AssertUnwindSafe(|| response.send()))?;
+        if let Err(error) = sent {
+            warning!(error = error; "Cannot send the response.");
+        }
+
+        Ok(())
+    }
 }
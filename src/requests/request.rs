@@ -1,7 +1,9 @@
+use std::error::Error;
 use std::io::{BufRead, BufReader};
-use std::net::TcpStream;
 
 use super::{Method, Version};
+use crate::reactor::{Cancellation, Ticket};
+use crate::sockets::Stream;
 
 /// HTTP request.
 ///
@@ -11,11 +13,12 @@ use super::{Method, Version};
 /// use std::net::TcpListener;
 ///
 /// use crate::requests::Request;
+/// use crate::sockets::Stream;
 ///
 /// let listener = TcpListener::bind("127.0.0.1:8000").unwrap();
 ///
 /// for stream in listener.incoming() {
-///     let request = Request::from(stream.unwrap());
+///     let request = Request::from(Stream::from(stream.unwrap()));
 ///
 ///     // Process the request after.
 /// }
@@ -27,7 +30,9 @@ pub struct Request {
     #[doc(hidden)]
     version: Version,
     #[doc(hidden)]
-    stream: TcpStream,
+    stream: Stream,
+    #[doc(hidden)]
+    ticket: Option<Ticket>,
 }
 
 impl Request {
@@ -35,13 +40,100 @@ impl Request {
         &self.method
     }
 
-    pub fn take_content(self) -> (Method, Version, TcpStream) {
+    pub fn take_content(self) -> (Method, Version, Stream) {
         (self.method, self.version, self.stream)
     }
+
+    /// Take the [`Ticket`] of the request, if the request is read by the reactor.
+    pub fn take_ticket(&mut self) -> Option<Ticket> {
+        self.ticket.take()
+    }
+
+    /// Write the response of the request with the outbox of the `ticket`, instead
+    /// of writing it on the stream in blocking mode, and cancel the request when
+    /// the client hangs up.
+    ///
+    /// # Returns
+    ///
+    /// Returns the instance [`Request`].
+    pub fn with_ticket(mut self, ticket: Ticket) -> Request {
+        self.ticket = Some(ticket);
+        self
+    }
+
+    /// Get the [`Cancellation`] of the request, cancelled when the client closes
+    /// the connection.
+    ///
+    /// The requests not read by the reactor are never cancelled.
+    pub fn cancellation(&self) -> Cancellation {
+        self.ticket
+            .as_ref()
+            .map(|ticket| ticket.cancellation().clone())
+            .unwrap_or_default()
+    }
+
+    /// Indicate if the client closed the connection, so the response is useless.
+    pub fn is_cancelled(&self) -> bool {
+        self.ticket
+            .as_ref()
+            .is_some_and(|ticket| ticket.cancellation().is_cancelled())
+    }
+
+    /// Duplicate the [`Stream`] of the request.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new handle to the same connection, or the error of the system.
+    pub fn try_clone_stream(&self) -> std::io::Result<Stream> {
+        self.stream.try_clone()
+    }
+
+    /// Create a [`Request`] from its `head`, already read from the `stream`.
+    ///
+    /// # Parameters
+    ///
+    /// - `head`: The request line and the headers, without the empty line.
+    /// - `stream`: The connection of the request.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Request`], or the error of the request line.
+    ///
+    /// # Examples
+    ///
+    /// ```rust
+    /// use std::net::TcpListener;
+    ///
+    /// use crate::requests::Request;
+    /// use crate::sockets::Stream;
+    ///
+    /// let listener = TcpListener::bind("127.0.0.1:8000").unwrap();
+    /// let (stream, _) = listener.accept().unwrap();
+    ///
+    /// let request = Request::parse("GET / HTTP/1.1\r\nHost: localhost", Stream::from(stream));
+    /// assert!(request.is_ok());
+    /// ```
+    pub fn parse(head: &str, stream: Stream) -> Result<Request, Box<dyn Error>> {
+        let first_line = head.lines().next().unwrap_or_default();
+        let method = Method::try_from(first_line)?;
+
+        let mut parts = first_line.split(' ');
+        // Drop the method verb
+        parts.next();
+        // Drop the URI
+        parts.next();
+
+        Ok(Request {
+            method,
+            version: Version::try_from(String::from_iter(parts))?,
+            stream,
+            ticket: None,
+        })
+    }
 }
 
-impl From<TcpStream> for Request {
-    /// Create a [`Request`] from a [`TcpStream`].
+impl From<Stream> for Request {
+    /// Create a [`Request`] from a [`Stream`].
     ///
     /// # Returns
     ///
@@ -52,27 +144,14 @@ impl From<TcpStream> for Request {
     /// - If the read of `stream` fails.
     /// - If the read of the method from the `stream`.
     /// - If the read of the version from the `stream`.
-    fn from(value: TcpStream) -> Request {
+    fn from(value: Stream) -> Request {
         let buffer_reader = BufReader::new(&value);
-        let mut http_request: Vec<_> = buffer_reader
+        let http_request: Vec<_> = buffer_reader
             .lines()
             .map(|result| result.unwrap())
             .take_while(|line| !line.is_empty())
             .collect();
 
-        let first_line = http_request.remove(0);
-        let method = Method::try_from(&first_line).unwrap();
-
-        let mut parts = first_line.split(' ');
-        // Drop the method verb
-        parts.next();
-        // Drop the URI
-        parts.next();
-
-        Request {
-            method,
-            version: Version::try_from(String::from_iter(parts)).unwrap(),
-            stream: value,
-        }
+        Self::parse(&http_request.join("\r\n"), value).unwrap()
     }
 }
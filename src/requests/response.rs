@@ -1,10 +1,13 @@
-use std::fmt::{Display, Formatter};
-use std::fs;
-use std::io::Write;
-use std::net::TcpStream;
+use std::io::{ErrorKind, Write};
 use std::path::Path;
 
-use super::{Request, Status, Version};
+use super::socket::{send_file, write_all_more, Cork};
+use super::{
+    Body, ChunkedWriter, FileRegion, HeaderName, HeaderValue, Headers, HttpDate, Producer, Request,
+    Status, Version,
+};
+use crate::reactor::{Outbox, Segment, Ticket};
+use crate::sockets::Stream;
 
 /// HTTP response.
 ///
@@ -31,12 +34,112 @@ pub struct Response {
     #[doc(hidden)]
     status: Status,
     #[doc(hidden)]
-    contents: String,
+    headers: Headers,
     #[doc(hidden)]
-    stream: TcpStream,
+    body: Body,
+    #[doc(hidden)]
+    stream: Option<Stream>,
+    #[doc(hidden)]
+    ticket: Option<Ticket>,
 }
 
 impl Response {
+    /// The headers written by [`Response::send()`], to frame the body and close
+    /// the connection. A listener cannot set them, else the response would have
+    /// conflicting framings.
+    pub const FRAMING_HEADERS: &'static [HeaderName] = &[
+        HeaderName::CONTENT_LENGTH,
+        HeaderName::TRANSFER_ENCODING,
+        HeaderName::CONNECTION,
+        HeaderName::DATE,
+    ];
+
+    /// Reject the [`Request`] with `503 SERVICE UNAVAILABLE`, and close the
+    /// connection.
+    ///
+    /// The response has no body and is built without a [`Response`], so the
+    /// rejection is cheap even if the server is overloaded. The client is asked to
+    /// retry after 1 second, with `Retry-After`.
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the write, if the client is gone.
+    ///
+    /// # Examples
+    ///
+    /// ```rust
+    /// use std::net::TcpListener;
+    ///
+    /// use crate::requests::{Request, Response};
+    /// use crate::sockets::Stream;
+    ///
+    /// let listener = TcpListener::bind("127.0.0.1:8000").unwrap();
+    ///
+    /// for stream in listener.incoming() {
+    ///     let request = Request::from(Stream::from(stream.unwrap()));
+    ///
+    ///     // The server is overloaded.
+    ///     Response::reject_unavailable(request).unwrap_or_default();
+    /// }
+    /// ```
+    pub fn reject_unavailable(request: Request) -> std::io::Result<()> {
+        let (_, _, stream) = request.take_content();
+        Self::reject_unavailable_stream(stream)
+    }
+
+    /// Reply `503 SERVICE UNAVAILABLE` on the `stream`, and close the connection.
+    ///
+    /// Like [`Response::reject_unavailable()`], when the [`Request`] is consumed,
+    /// like by a listener exceeding its deadline.
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the write, if the client is gone.
+    pub fn reject_unavailable_stream(stream: Stream) -> std::io::Result<()> {
+        Self::reject(stream, Status::ServiceUnavailable, b"Retry-After: 1\r\n")
+    }
+
+    /// Reply `408 REQUEST TIMEOUT` on the `stream`, and close the connection.
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the write, if the client is gone.
+    pub fn reject_request_timeout(stream: Stream) -> std::io::Result<()> {
+        Self::reject(stream, Status::RequestTimeout, b"")
+    }
+
+    /// Reply `500 INTERNAL SERVER ERROR` on the `stream`, and close the
+    /// connection.
+    ///
+    /// The response is built without a [`Response`], so it is sent even if the
+    /// listener panicked before creating its own.
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the write, if the client is gone.
+    pub fn reject_internal_error(stream: Stream) -> std::io::Result<()> {
+        Self::reject(stream, Status::InternalServerError, b"")
+    }
+
+    /// Reply the `status` without body on the `stream`, with the serialized
+    /// `headers`, the `Date`, and close the connection.
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the write, if the client is gone.
+    #[doc(hidden)]
+    fn reject(mut stream: Stream, status: Status, headers: &[u8]) -> std::io::Result<()> {
+        let mut buffer = Vec::with_capacity(Self::HEAD_CAPACITY);
+
+        write!(buffer, "{} {}\r\n", Version::Http1_1, status).unwrap();
+        buffer.extend_from_slice(headers);
+        buffer.extend_from_slice(b"Date: ");
+        buffer.extend_from_slice(HttpDate::now().as_bytes());
+        buffer.extend_from_slice(b"\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+
+        stream.write_all(&buffer)
+    }
+
     /// Add the content of the file to the [`Response`].
     ///
     /// # Returns
@@ -62,14 +165,99 @@ impl Response {
     ///     response.send();
     /// }
     /// ```
+    ///
+    /// # Panics
+    ///
+    /// - If the body is streamed, cf.[`Body::append_file()`].
     pub fn add_file(&mut self, path: impl AsRef<Path>) -> Result<&mut Response, std::io::Error> {
-        fs::read_to_string(path.as_ref()).map(|contents| {
-            self.contents += &contents.to_owned();
-            self
-        })
+        let path = path.as_ref();
+        self.body.append_file(path)?;
+
+        if !self.headers.contains(&HeaderName::CONTENT_TYPE) {
+            self.headers
+                .insert(HeaderName::CONTENT_TYPE, Self::content_type(path));
+        }
+
+        Ok(self)
+    }
+
+    /// Insert the header, and replace the previous value with the same name.
+    ///
+    /// # Returns
+    ///
+    /// Returns the instance [`Response`].
+    ///
+    /// # Panics
+    ///
+    /// - If the header is written by [`Response::send()`], like `Content-Length`,
+    /// cf.[`Response::FRAMING_HEADERS`].
+    /// - If the name or the value is invalid, cf.[`HeaderName`] and
+    /// [`HeaderValue`].
+    ///
+    /// # Examples
+    ///
+    /// ```rust
+    /// use crate::requests::{HeaderName, Request, Response, Status};
+    ///
+    /// fn process(request: Request) -> Response {
+    ///     let mut response = Response::from((request, Status::Ok));
+    ///     response
+    ///         .insert_header(HeaderName::CACHE_CONTROL, "max-age=3600")
+    ///         .insert_header(HeaderName::VARY, "Accept-Encoding");
+    ///
+    ///     response
+    /// }
+    /// ```
+    pub fn insert_header(
+        &mut self,
+        name: impl Into<HeaderName>,
+        value: impl Into<HeaderValue>,
+    ) -> &mut Response {
+        let name = name.into();
+        assert!(
+            !Self::FRAMING_HEADERS.contains(&name),
+            "The header {name} is written by the send of the response."
+        );
+
+        self.headers.insert(name, value);
+        self
+    }
+
+    /// Replace the body of the [`Response`].
+    ///
+    /// # Returns
+    ///
+    /// Returns the instance [`Response`].
+    ///
+    /// # Examples
+    ///
+    /// Check examples of [`Body`].
+    pub fn set_body(&mut self, body: impl Into<Body>) -> &mut Response {
+        self.body = body.into();
+        self
+    }
+
+    /// Stream the body of the [`Response`], instead of sending its contents.
+    ///
+    /// The `producer` is called by [`Response::send()`] after the head of the
+    /// response, and pushes the body chunk by chunk into the [`ChunkedWriter`].
+    /// The previous body is replaced.
+    ///
+    /// # Returns
+    ///
+    /// Returns the instance [`Response`].
+    ///
+    /// # Examples
+    ///
+    /// Check examples of [`ChunkedWriter`].
+    pub fn stream(
+        &mut self,
+        producer: impl FnOnce(&mut ChunkedWriter<'_>) -> std::io::Result<()> + Send + 'static,
+    ) -> &mut Response {
+        self.set_body(Producer::from(producer))
     }
 
-    /// Send the response to the stream [`TcpStream`].
+    /// Send the response to the stream [`Stream`].
     ///
     /// # Examples
     ///
@@ -88,25 +276,255 @@ impl Response {
     /// }
     /// ```
     ///
+    /// If the request is read by the reactor, the response is handed over to it
+    /// and written when the socket is writable, so the worker does not wait the
+    /// client, cf.[`Outbox`]. If the client already closed the connection, the
+    /// response is dropped.
+    ///
+    /// A client closing the connection during the send is not an error, the
+    /// rest of the response is dropped. If the [`Producer`] of a streamed body
+    /// fails, the body ends without its last chunk, so the client sees it is
+    /// truncated.
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the write or of the [`Producer`], except for a
+    /// disconnection, or nothing if all is good.
+    ///
     /// # Panics
     ///
-    /// - If the [`TcpStream::write_all`] panics.
-    pub fn send(&mut self) {
-        self.stream.write_all(self.to_string().as_bytes()).unwrap()
+    /// - If the response is already sent.
+    pub fn send(&mut self) -> std::io::Result<()> {
+        let body = std::mem::take(&mut self.body);
+
+        let sent = match (self.ticket.take(), body) {
+            (Some(ticket), _) if ticket.cancellation().is_cancelled() => {
+                self.stream.take().expect("The response is already sent");
+                Ok(())
+            }
+            (Some(ticket), Body::Stream(producer)) => self.queue_stream(ticket, producer),
+            (Some(ticket), body) => {
+                self.queue_body(&ticket.into_outbox(), body);
+                Ok(())
+            }
+            (None, Body::Stream(producer)) => self.send_stream(producer),
+            (None, body) => self.send_body(body),
+        };
+
+        match sent {
+            Err(error) if Self::is_disconnection(&error) => Ok(()),
+            sent => sent,
+        }
     }
-}
 
-impl Display for Response {
-    fn fmt(&self, f: &mut Formatter<'_>) -> std::fmt::Result {
-        write!(
-            f,
-            "{} {}\r\nContent-Length: {}\r\n\r\n{}",
-            &self.version,
-            &self.status,
-            self.contents.len(),
-            &self.contents,
+    /// Indicate if the `error` comes from a client closing the connection, or no
+    /// longer reading it.
+    #[doc(hidden)]
+    fn is_disconnection(error: &std::io::Error) -> bool {
+        matches!(
+            error.kind(),
+            ErrorKind::BrokenPipe
+                | ErrorKind::ConnectionReset
+                | ErrorKind::ConnectionAborted
+                | ErrorKind::WouldBlock
+                | ErrorKind::TimedOut
         )
     }
+
+    /// Send the head of the response with the `Content-Length`, then the `body`.
+    ///
+    /// The bytes in memory are sent with the head in only one write. A file is sent
+    /// after the head on the corked stream with `sendfile`, so the head leaves with
+    /// the first bytes of the file, without copying the file in the process.
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the write, or nothing if all is good.
+    ///
+    /// # Panics
+    ///
+    /// - If the `body` is streamed.
+    #[doc(hidden)]
+    fn send_body(&mut self, body: Body) -> std::io::Result<()> {
+        let (buffer, file) = self.frame_body(body);
+        let mut stream = self.stream.as_ref().expect("The response is already sent");
+
+        match file {
+            Some(file) => {
+                let _cork = Cork::new(stream);
+                stream.write_all(&buffer)?;
+                send_file(stream, &file)
+            }
+            None => stream.write_all(&buffer),
+        }
+    }
+
+    /// Hand over the head of the response with the `Content-Length`, and the
+    /// `body`, to the `outbox`.
+    ///
+    /// # Panics
+    ///
+    /// - If the `body` is streamed.
+    #[doc(hidden)]
+    fn queue_body(&mut self, outbox: &Outbox, body: Body) {
+        let (buffer, file) = self.frame_body(body);
+        let stream = self.stream.take().expect("The response is already sent");
+
+        let mut segments = vec![Segment::Bytes(buffer)];
+        segments.extend(file.map(Segment::File));
+        outbox.send(stream, segments);
+    }
+
+    /// Serialize the head of the response with the `Content-Length`, followed by
+    /// the `body` if it is in memory.
+    ///
+    /// # Returns
+    ///
+    /// Returns the serialized bytes, and the region of the file to send after
+    /// them.
+    ///
+    /// # Panics
+    ///
+    /// - If the `body` is streamed.
+    #[doc(hidden)]
+    fn frame_body(&self, body: Body) -> (Vec<u8>, Option<FileRegion>) {
+        let length = body.len().unwrap_or_default();
+        let mut buffer = Vec::with_capacity(Self::HEAD_CAPACITY + length as usize);
+
+        self.write_head(&mut buffer);
+        write!(buffer, "Content-Length: {length}\r\n\r\n").unwrap();
+
+        match body {
+            Body::Shared(bytes) => buffer.extend_from_slice(&bytes),
+            Body::Owned(bytes) => buffer.extend_from_slice(&bytes),
+            Body::File(file) => return (buffer, Some(file)),
+            Body::Stream(_) => panic!("A streamed body must be sent by its producer."),
+        }
+
+        (buffer, None)
+    }
+
+    /// Send the head of the response, then the body pushed by the `producer`.
+    ///
+    /// The head is sent with `MSG_MORE`, to leave with the first chunk.
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the write or of the `producer`, or nothing if all is
+    /// good.
+    #[doc(hidden)]
+    fn send_stream(&mut self, producer: Producer) -> std::io::Result<()> {
+        let (buffer, chunked) = self.frame_stream();
+        let stream = self.stream.as_mut().expect("The response is already sent");
+        write_all_more(stream, &buffer)?;
+
+        let mut writer = ChunkedWriter::new(stream, chunked);
+        producer.produce(&mut writer)?;
+        writer.finish()
+    }
+
+    /// Hand over the head of the response to the outbox of the `ticket`, then
+    /// the body pushed by the `producer`.
+    ///
+    /// The `producer` waits when the queue of the connection is full, cf.
+    /// [`Outbox::send_streamed()`], and its writes fail once the client closes
+    /// the connection.
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the `producer`, or nothing if all is good.
+    #[doc(hidden)]
+    fn queue_stream(&mut self, ticket: Ticket, producer: Producer) -> std::io::Result<()> {
+        let (buffer, chunked) = self.frame_stream();
+        let stream = self.stream.take().expect("The response is already sent");
+        let cancellation = ticket.cancellation().clone();
+        let mut pipe = ticket.outbox().send_streamed(stream, buffer, cancellation);
+
+        let mut writer = ChunkedWriter::new(&mut pipe, chunked);
+        let produced = producer.produce(&mut writer).and_then(|()| writer.finish());
+
+        // The connection is released before the end of the response, cf.
+        // [`Ticket::into_outbox()`].
+        drop(ticket);
+        produced
+    }
+
+    /// Serialize the head of a streamed response.
+    ///
+    /// The body uses the chunked transfer-encoding since `HTTP/1.1`, else it is
+    /// delimited by the close of the connection.
+    ///
+    /// # Returns
+    ///
+    /// Returns the serialized head, and if the body is chunked.
+    #[doc(hidden)]
+    fn frame_stream(&self) -> (Vec<u8>, bool) {
+        let chunked = self.version >= Version::Http1_1;
+        let mut buffer = Vec::with_capacity(Self::HEAD_CAPACITY);
+
+        self.write_head(&mut buffer);
+        buffer.extend_from_slice(if chunked {
+            b"Transfer-Encoding: chunked\r\n\r\n"
+        } else {
+            b"\r\n"
+        });
+
+        (buffer, chunked)
+    }
+
+    /// The initial capacity of the buffer of the head.
+    #[doc(hidden)]
+    const HEAD_CAPACITY: usize = 256;
+
+    /// Serialize the status line, the headers, the `Date` and `Connection: close`
+    /// at the end of the `buffer`, without the framing header and the empty line.
+    ///
+    /// The server closes the connection after every response, so it says so
+    /// explicitly, even to the `HTTP/1.1` clients.
+    #[doc(hidden)]
+    fn write_head(&self, buffer: &mut Vec<u8>) {
+        write!(buffer, "{} {}\r\n", &self.version, &self.status).unwrap();
+        self.headers.write_to(buffer);
+
+        buffer.extend_from_slice(b"Date: ");
+        buffer.extend_from_slice(HttpDate::now().as_bytes());
+        buffer.extend_from_slice(b"\r\nConnection: close\r\n");
+    }
+
+    /// Guess the `Content-Type` from the extension of the file.
+    ///
+    /// # Returns
+    ///
+    /// Returns the media type, or `application/octet-stream` if the extension is
+    /// unknown.
+    #[doc(hidden)]
+    fn content_type(path: &Path) -> &'static str {
+        let extension = path
+            .extension()
+            .and_then(|extension| extension.to_str())
+            .unwrap_or_default()
+            .to_ascii_lowercase();
+
+        match extension.as_str() {
+            "html" | "htm" => "text/html; charset=utf-8",
+            "css" => "text/css; charset=utf-8",
+            "js" | "mjs" => "text/javascript; charset=utf-8",
+            "json" => "application/json",
+            "txt" => "text/plain; charset=utf-8",
+            "svg" => "image/svg+xml",
+            "png" => "image/png",
+            "jpg" | "jpeg" => "image/jpeg",
+            "gif" => "image/gif",
+            "webp" => "image/webp",
+            "ico" => "image/x-icon",
+            "woff" => "font/woff",
+            "woff2" => "font/woff2",
+            "ttf" => "font/ttf",
+            "wasm" => "application/wasm",
+            "pdf" => "application/pdf",
+            _ => "application/octet-stream",
+        }
+    }
 }
 
 impl From<(Request, Status)> for Response {
@@ -116,14 +534,100 @@ impl From<(Request, Status)> for Response {
     ///
     /// Returns a new instance of [`Response`].
     fn from(value: (Request, Status)) -> Response {
-        let request = value.0;
+        let mut request = value.0;
+        let ticket = request.take_ticket();
         let (_, version, stream) = request.take_content();
 
         Self {
             version,
-            contents: String::new(),
+            headers: Headers::default(),
+            body: Body::default(),
             status: value.1,
-            stream,
+            stream: Some(stream),
+            ticket,
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::{Body, HeaderName, Headers, Response, Status, Version};
+
+    /// Create a response of `HTTP/1.1`, without connection.
+    fn response() -> Response {
+        Response {
+            version: Version::Http1_1,
+            status: Status::Ok,
+            headers: Headers::default(),
+            body: Body::default(),
+            stream: None,
+            ticket: None,
+        }
+    }
+
+    /// Get the names of the headers in the serialized `head`.
+    fn names(head: &[u8]) -> Vec<HeaderName> {
+        String::from_utf8_lossy(head)
+            .lines()
+            .skip(1)
+            .filter_map(|line| line.split_once(": "))
+            .map(|(name, _)| HeaderName::try_from(name.to_owned()).unwrap())
+            .collect()
+    }
+
+    #[test]
+    #[should_panic(expected = "is written by the send of the response")]
+    fn reject_the_content_length() {
+        response().insert_header(HeaderName::CONTENT_LENGTH, "0");
+    }
+
+    #[test]
+    #[should_panic(expected = "is written by the send of the response")]
+    fn reject_the_connection() {
+        response().insert_header(HeaderName::CONNECTION, "keep-alive");
+    }
+
+    #[test]
+    #[should_panic(expected = "is written by the send of the response")]
+    fn reject_a_framing_header_in_any_case() {
+        response().insert_header(HeaderName::from("transfer-encoding"), "chunked");
+    }
+
+    #[test]
+    fn reject_all_framing_headers() {
+        for name in Response::FRAMING_HEADERS {
+            let inserted = std::panic::catch_unwind(|| {
+                response().insert_header(name.clone(), "value");
+            });
+            assert!(inserted.is_err(), "{name} is accepted");
+        }
+    }
+
+    #[test]
+    fn write_each_framing_header_once() {
+        let mut response = response();
+        response.insert_header(HeaderName::CACHE_CONTROL, "no-cache");
+
+        let (framed, file) = response.frame_body(Body::from(String::from("Hello")));
+        assert!(file.is_none());
+        assert!(framed.ends_with(b"Content-Length: 5\r\n\r\nHello"));
+
+        let (streamed, chunked) = response.frame_stream();
+        assert!(chunked);
+        assert!(streamed.ends_with(b"Transfer-Encoding: chunked\r\n\r\n"));
+
+        let mut written = names(&framed);
+        written.extend(names(&streamed));
+        for name in Response::FRAMING_HEADERS {
+            let count = written.iter().filter(|written| *written == name).count();
+            assert!(count >= 1, "{name} is never written");
+        }
+        for head in [&framed, &streamed] {
+            let names = names(head);
+            for name in &names {
+                let count = names.iter().filter(|other| *other == name).count();
+                assert_eq!(count, 1, "{name} is written {count} times");
+            }
         }
     }
 }
@@ -0,0 +1,213 @@
+use std::io::ErrorKind;
+
+use super::FileRegion;
+use crate::sockets::Stream;
+
+/// Guard that corks a [`Stream`] until it is dropped.
+///
+/// While the stream is corked, the kernel only sends full segments. So, the head
+/// and the body of a response, written separately, leave in the fewest segments,
+/// without a tiny segment containing only the head.
+///
+/// The guard only borrows the stream, so the writes go to the stream itself, and
+/// a file is still sent with [`send_file()`], without copy.
+///
+/// On other systems than Linux, or on a Unix domain socket, the guard does
+/// nothing.
+///
+/// # How to use it?
+///
+/// ```rust
+/// use std::io::Write;
+/// use std::net::TcpStream;
+///
+/// use crate::requests::socket::Cork;
+/// use crate::sockets::Stream;
+///
+/// let mut stream = Stream::from(TcpStream::connect("127.0.0.1:8000").unwrap());
+///
+/// let cork = Cork::new(&stream);
+/// (&stream).write_all(b"HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\n").unwrap();
+/// (&stream).write_all(b"Hello").unwrap();
+///
+/// // The pending bytes are sent when the guard is dropped.
+/// drop(cork);
+/// ```
+#[derive(Debug)]
+pub struct Cork<'a> {
+    #[doc(hidden)]
+    stream: &'a Stream,
+}
+
+impl<'a> Cork<'a> {
+    /// Cork the `stream`.
+    ///
+    /// If the stream cannot be corked, the bytes are sent like without the guard.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Cork`].
+    pub fn new(stream: &'a Stream) -> Cork<'a> {
+        let _ = Self::set_cork(stream, true);
+        Self { stream }
+    }
+
+    /// Set the `TCP_CORK` option of the `stream`.
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the system call, or nothing if all is good.
+    #[cfg(target_os = "linux")]
+    #[doc(hidden)]
+    fn set_cork(stream: &Stream, enabled: bool) -> std::io::Result<()> {
+        use std::os::fd::AsRawFd;
+
+        let value = libc::c_int::from(enabled);
+
+        // SAFETY: The file descriptor is owned by the stream, and the option
+        // value is a valid `c_int` living during the call.
+        let result = unsafe {
+            libc::setsockopt(
+                stream.as_raw_fd(),
+                libc::IPPROTO_TCP,
+                libc::TCP_CORK,
+                (&value as *const libc::c_int).cast(),
+                std::mem::size_of::<libc::c_int>() as libc::socklen_t,
+            )
+        };
+
+        if result == 0 {
+            Ok(())
+        } else {
+            Err(std::io::Error::last_os_error())
+        }
+    }
+
+    #[cfg(not(target_os = "linux"))]
+    #[doc(hidden)]
+    fn set_cork(_stream: &Stream, _enabled: bool) -> std::io::Result<()> {
+        Ok(())
+    }
+}
+
+impl Drop for Cork<'_> {
+    /// Uncork the stream, to send the pending bytes.
+    fn drop(&mut self) {
+        let _ = Self::set_cork(self.stream, false);
+    }
+}
+
+/// Send the bytes of the `region` to the blocking `stream`, with `sendfile`.
+///
+/// The bytes go from the page cache to the socket without being copied in the
+/// process. On other systems than Linux, the bytes are read then written.
+///
+/// # Returns
+///
+/// Returns the error of the system call, or nothing if all is good.
+#[cfg(target_os = "linux")]
+pub fn send_file(stream: &Stream, region: &FileRegion) -> std::io::Result<()> {
+    use std::os::fd::AsRawFd;
+
+    let mut offset = region.offset() as libc::off_t;
+    let end = (region.offset() + region.length()) as libc::off_t;
+
+    while offset < end {
+        // SAFETY: The file descriptors are owned by the stream and the region,
+        // and the offset lives during the call.
+        let written = unsafe {
+            libc::sendfile(
+                stream.as_raw_fd(),
+                region.file().as_raw_fd(),
+                &mut offset,
+                (end - offset) as usize,
+            )
+        };
+
+        match written {
+            -1 => {
+                let error = std::io::Error::last_os_error();
+                if error.kind() != ErrorKind::Interrupted {
+                    return Err(error);
+                }
+            }
+            // The file is shorter than the region.
+            0 => return Err(ErrorKind::UnexpectedEof.into()),
+            _ => {}
+        }
+    }
+
+    Ok(())
+}
+
+#[cfg(not(target_os = "linux"))]
+pub fn send_file(mut stream: &Stream, region: &FileRegion) -> std::io::Result<()> {
+    use std::io::Write;
+    use std::os::unix::fs::FileExt;
+
+    let mut buffer = vec![0; 64 * 1024];
+    let mut position = 0;
+
+    while position < region.length() {
+        let length = (region.length() - position).min(buffer.len() as u64) as usize;
+        let read = region
+            .file()
+            .read_at(&mut buffer[..length], region.offset() + position)?;
+        if read == 0 {
+            return Err(ErrorKind::UnexpectedEof.into());
+        }
+
+        stream.write_all(&buffer[..read])?;
+        position += read as u64;
+    }
+
+    Ok(())
+}
+
+/// Write all bytes to the `stream`, and indicate to the kernel that more bytes
+/// follow with `MSG_MORE`.
+///
+/// The bytes are coalesced with the next write, instead of being sent alone,
+/// even if `TCP_NODELAY` is set. On other systems than Linux, the bytes are
+/// written normally.
+///
+/// # Returns
+///
+/// Returns the error of the system call, or nothing if all is good.
+#[cfg(target_os = "linux")]
+pub fn write_all_more(stream: &mut Stream, mut bytes: &[u8]) -> std::io::Result<()> {
+    use std::os::fd::AsRawFd;
+
+    while !bytes.is_empty() {
+        // SAFETY: The file descriptor is owned by the stream, and the pointer
+        // and the length come from the same living slice.
+        let written = unsafe {
+            libc::send(
+                stream.as_raw_fd(),
+                bytes.as_ptr().cast(),
+                bytes.len(),
+                libc::MSG_MORE | libc::MSG_NOSIGNAL,
+            )
+        };
+
+        match written {
+            -1 => {
+                let error = std::io::Error::last_os_error();
+                if error.kind() != ErrorKind::Interrupted {
+                    return Err(error);
+                }
+            }
+            0 => return Err(ErrorKind::WriteZero.into()),
+            written => bytes = &bytes[written as usize..],
+        }
+    }
+
+    Ok(())
+}
+
+#[cfg(not(target_os = "linux"))]
+pub fn write_all_more(stream: &mut Stream, bytes: &[u8]) -> std::io::Result<()> {
+    use std::io::Write;
+
+    stream.write_all(bytes)
+}
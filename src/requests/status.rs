@@ -23,6 +23,21 @@ pub enum Status {
     ///
     /// [MDN - 404 NOT FOUND](https://developer.mozilla.org/en-US/docs/Web/HTTP/Status/404)
     NotFound,
+
+    /// HTTP status `REQUEST TIMEOUT`.
+    ///
+    /// [MDN - 408 REQUEST TIMEOUT](https://developer.mozilla.org/en-US/docs/Web/HTTP/Status/408)
+    RequestTimeout,
+
+    /// HTTP status `INTERNAL SERVER ERROR`.
+    ///
+    /// [MDN - 500 INTERNAL SERVER ERROR](https://developer.mozilla.org/en-US/docs/Web/HTTP/Status/500)
+    InternalServerError,
+
+    /// HTTP status `SERVICE UNAVAILABLE`.
+    ///
+    /// [MDN - 503 SERVICE UNAVAILABLE](https://developer.mozilla.org/en-US/docs/Web/HTTP/Status/503)
+    ServiceUnavailable,
 }
 
 impl Display for Status {
@@ -30,6 +45,9 @@ impl Display for Status {
         let (code, name) = match self {
             Self::Ok => (200, "OK"),
             Self::NotFound => (404, "NOT FOUND"),
+            Self::RequestTimeout => (408, "REQUEST TIMEOUT"),
+            Self::InternalServerError => (500, "INTERNAL SERVER ERROR"),
+            Self::ServiceUnavailable => (503, "SERVICE UNAVAILABLE"),
         };
 
         write!(f, "{} {}", code, name)
@@ -1,13 +1,17 @@
+use std::future::Future;
 use std::path::Path;
+use std::pin::Pin;
 use std::thread::sleep;
 use std::time::Duration;
 
+use crate::reactor;
 use crate::requests::{Request, Response, Status};
 
 /// Process the `GET /slow_request`.
 ///
 /// The function sleeps 5 secondes before returning the response, to simulate a slow
-/// request to process.
+/// request to process. It stops sleeping when the client closes the connection,
+/// cf.[`Request::cancellation()`].
 ///
 /// # Returns
 ///
@@ -27,11 +31,52 @@ use crate::requests::{Request, Response, Status};
 ///
 /// [add_listener]: crate::server::WebServer::add_listener()
 pub fn get(request: Request) -> Response {
+    let cancellation = request.cancellation();
     let mut response = Response::from((request, Status::Ok));
     response
         .add_file(Path::new("templates/slow_request.html"))
         .unwrap();
 
-    sleep(Duration::from_secs(5));
+    // The response is dropped by the send if the client is gone.
+    for _ in 0..50 {
+        if cancellation.is_cancelled() {
+            break;
+        }
+        sleep(Duration::from_millis(100));
+    }
     response
 }
+
+/// Process the `GET /slow_request` without blocking.
+///
+/// The future waits 5 secondes before returning the response, like [`get()`], but
+/// the wait does not occupy any thread, cf.[`reactor::sleep()`].
+///
+/// # Returns
+///
+/// Returns the future of the response to send with [`Response::send()`], with
+/// the HTML page [`templates/slow_request.html`](/templates/slow_request.html).
+///
+/// # Panics
+///
+/// If the method [`Response::add_file()`] returns an error when adding a file.
+///
+/// # Examples
+///
+/// Check examples of [`WebServer::add_async_listener()`][add_async_listener],
+/// to see how to add the function to process the `GET /slow_request`.
+///
+/// <!-- References -->
+///
+/// [add_async_listener]: crate::server::WebServer::add_async_listener()
+pub fn get_async(request: Request) -> Pin<Box<dyn Future<Output = Response> + Send>> {
+    Box::pin(async move {
+        let mut response = Response::from((request, Status::Ok));
+        response
+            .add_file(Path::new("templates/slow_request.html"))
+            .unwrap();
+
+        reactor::sleep(Duration::from_secs(5)).await;
+        response
+    })
+}
@@ -0,0 +1,36 @@
+use std::io::Write;
+
+use crate::requests::{HeaderName, Request, Response, Status};
+
+/// Process the `GET /stream`.
+///
+/// The body is streamed line by line, cf.[`Response::stream()`], so it is never
+/// held in memory: with `HTTP/1.1`, the client receives it in chunks.
+///
+/// # Returns
+///
+/// Returns the response to send with [`Response::send()`], with 100 000 lines of
+/// plain text.
+///
+/// # Examples
+///
+/// Check examples of [`WebServer::add_listener()`][add_listener],
+/// to see how to add the function to process the `GET /stream`.
+///
+/// <!-- References -->
+///
+/// [add_listener]: crate::server::WebServer::add_listener()
+pub fn get(request: Request) -> Response {
+    let mut response = Response::from((request, Status::Ok));
+    response
+        .insert_header(HeaderName::CONTENT_TYPE, "text/plain; charset=utf-8")
+        .stream(|writer| {
+            for line in 0..100_000 {
+                writeln!(writer, "Line {line}")?;
+            }
+
+            writer.flush()
+        });
+
+    response
+}
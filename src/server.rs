@@ -1,18 +1,26 @@
-//! Module providing [`WebServer`], [`enum@Debug`] and [`Method`].
+//! Module providing [`WebServer`], [`enum@Debug`], [`Lane`], [`Method`],
+//! [`Scheduler`] and [`Timeouts`].
 //!
 //! To see how to create the web server, go to the class [`WebServer`].
 
 use std::collections::HashMap;
 use std::fmt::{Display, Formatter};
-use std::io::ErrorKind::WouldBlock;
-use std::net::{Ipv4Addr, SocketAddrV4, TcpListener, TcpStream};
+use std::net::{Ipv4Addr, SocketAddrV4};
 use std::num::NonZeroUsize;
+use std::os::fd::AsFd;
 use std::path::Path;
 use std::sync::{Arc, Mutex};
+use std::time::{Duration, Instant};
 
+use crate::logging::{debug, info, warning};
+pub use crate::reactor::Timeouts;
+use crate::reactor::{cancellable, timeout, Reactor};
 pub use crate::requests::Method;
-use crate::requests::{HTTPListener, Job, Request, Response, Status};
-use crate::threads::WorkerPool;
+use crate::requests::{AsyncListener, HTTPListener, Job, Request, Response, Status};
+use crate::sockets::{self, Handoff, Listener};
+pub use crate::sockets::{Endpoint, KeepAlive};
+pub use crate::threads::{Admission, Affinity, BusyPoll, Codel, Placement, Scaling, Scheduler};
+use crate::threads::{PushError, WorkerPool};
 
 /// The web server.
 ///
@@ -38,12 +46,29 @@ pub struct WebServer {
     #[doc(hidden)]
     debug: bool,
     #[doc(hidden)]
-    listeners: HashMap<Method, HTTPListener>,
+    listeners: HashMap<Method, Route>,
     #[doc(hidden)]
     workers: WorkerPool,
+    #[doc(hidden)]
+    blocking: Option<WorkerPool>,
+    #[doc(hidden)]
+    timeouts: Timeouts,
+    #[doc(hidden)]
+    handoff: Option<Handoff>,
+    #[doc(hidden)]
+    endpoints: Vec<Endpoint>,
 }
 
 impl WebServer {
+    /// The maximal duration between two checks of the shutdown request.
+    #[doc(hidden)]
+    const SHUTDOWN_CHECK_INTERVAL: Duration = Duration::from_millis(100);
+
+    /// The duration given to the workers after the drain, so the listeners
+    /// cancelled by the close of their connection can end.
+    #[doc(hidden)]
+    const CANCELLATION_GRACE: Duration = Duration::from_millis(500);
+
     /// Create the [`WebServer`].
     ///
     /// # Parameters
@@ -67,11 +92,82 @@ impl WebServer {
     ///
     /// - If `amount_workers` is equal to 0.
     pub fn new(amount_workers: NonZeroUsize, debug: Debug) -> WebServer {
+        Self::with_scheduler(amount_workers, Scheduler::default(), debug)
+    }
+
+    /// Create the [`WebServer`], with the [`Scheduler`] of its workers.
+    ///
+    /// # Parameters
+    ///
+    /// - `amount_workers`: The number must be greater than 0, else panics.
+    /// - `scheduler`: The strategy to give the requests to the workers.
+    /// - `debug`: Activate the debug mode of the server, cf.[`enum@Debug`].
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`WebServer`].
+    ///
+    /// # Examples
+    ///
+    /// ```rust
+    /// use crate::server::{Debug, Placement, Scheduler, WebServer};
+    ///
+    /// let server = WebServer::with_scheduler(
+    ///     5,
+    ///     Scheduler::WorkStealing(Placement::LeastLoaded),
+    ///     Debug::False,
+    /// );
+    /// ```
+    pub fn with_scheduler(
+        amount_workers: NonZeroUsize,
+        scheduler: Scheduler,
+        debug: Debug,
+    ) -> WebServer {
+        let workers = WorkerPool::builder(Scaling::fixed(amount_workers))
+            .scheduler(scheduler)
+            .build();
+
+        Self::with_pool(workers, debug)
+    }
+
+    /// Create the [`WebServer`], with its [`WorkerPool`].
+    ///
+    /// # Parameters
+    ///
+    /// - `workers`: The pool executing the requests.
+    /// - `debug`: Activate the debug mode of the server, cf.[`enum@Debug`].
+    /// In debug mode, the changes of the amount of workers are printed.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`WebServer`].
+    ///
+    /// # Examples
+    ///
+    /// ```rust
+    /// use std::num::NonZeroUsize;
+    ///
+    /// use crate::server::{Debug, Scaling, Scheduler, WebServer};
+    /// use crate::threads::{PushError, WorkerPool};
+    ///
+    /// let scaling = Scaling::new(NonZeroUsize::new(2).unwrap(), NonZeroUsize::new(16).unwrap());
+    /// let server = WebServer::with_pool(
+    ///     WorkerPool::builder(scaling)
+    ///         .scheduler(Scheduler::Shared)
+    ///         .build(),
+    ///     Debug::False,
+    /// );
+    /// ```
+    pub fn with_pool(workers: WorkerPool, debug: Debug) -> WebServer {
         Self {
             cpt: 0,
             debug: debug == Debug::True,
             listeners: HashMap::new(),
-            workers: WorkerPool::new(amount_workers),
+            workers,
+            blocking: None,
+            timeouts: Timeouts::default(),
+            handoff: None,
+            endpoints: vec![Endpoint::tcp(SocketAddrV4::new(Ipv4Addr::LOCALHOST, 8000))],
         }
     }
 
@@ -105,18 +201,251 @@ impl WebServer {
     ///
     /// - If the `method` is already registered.
     pub fn add_listener(&mut self, method: Method, listener: HTTPListener) -> &mut WebServer {
+        self.add_listener_on(method, listener, Lane::Fast)
+    }
+
+    /// Add the route with the [`Method`] and the [`HTTPListener`], executed on the
+    /// pool of the [`Lane`].
+    ///
+    /// # Parameters
+    ///
+    /// - `method`: The [`Method`] to register.
+    /// The `method` must not be yet registered, else panics.
+    /// - `listener`: The function to process the incoming request for the `method`.
+    /// - `lane`: The pool executing the `listener`.
+    ///
+    /// # Returns
+    ///
+    /// Returns the mutable reference to the current instance of [`WebServer`].
+    ///
+    /// # Examples
+    ///
+    /// ```rust
+    /// use crate::server::{Debug, Lane, WebServer};
+    /// use crate::requests::{Method, Status, Request, Response};
+    ///
+    /// fn slow(request: Request) -> Response {
+    ///     std::thread::sleep(std::time::Duration::from_secs(5));
+    ///     request.make_response_with_status(Status::OK)
+    /// }
+    ///
+    /// let server = WebServer::new(5, Debug::False);
+    /// server.add_listener_on(Method::get("/slow"), slow, Lane::Blocking);
+    /// ```
+    ///
+    /// # Panics
+    ///
+    /// - If the `method` is already registered.
+    pub fn add_listener_on(
+        &mut self,
+        method: Method,
+        listener: HTTPListener,
+        lane: Lane,
+    ) -> &mut WebServer {
         assert!(
             !self.listeners.contains_key(&method),
             "A listener is always registered for {}",
             method,
         );
 
-        self.listeners.insert(method, listener);
+        self.listeners.insert(method, Route::Sync(listener, lane));
 
         self
     }
 
-    /// Execute the server and process incoming requests on `127.0.0.1:8000`.
+    /// Add the route with the [`Method`] and the [`AsyncListener`].
+    ///
+    /// The future of the listener is executed by the reactor of the server, so a
+    /// waiting request does not occupy any worker. The future is dropped when
+    /// the client closes the connection.
+    ///
+    /// # Parameters
+    ///
+    /// - `method`: The [`Method`] to register.
+    /// The `method` must not be yet registered, else panics.
+    /// - `listener`: The function to process the incoming request for the `method`.
+    ///
+    /// # Returns
+    ///
+    /// Returns the mutable reference to the current instance of [`WebServer`].
+    ///
+    /// # Examples
+    ///
+    /// ```rust
+    /// use std::future::Future;
+    /// use std::pin::Pin;
+    /// use std::time::Duration;
+    ///
+    /// use crate::reactor::sleep;
+    /// use crate::server::{Debug, WebServer};
+    /// use crate::requests::{Method, Status, Request, Response};
+    ///
+    /// fn slow(request: Request) -> Pin<Box<dyn Future<Output = Response> + Send>> {
+    ///     Box::pin(async move {
+    ///         sleep(Duration::from_secs(5)).await;
+    ///         request.make_response_with_status(Status::OK)
+    ///     })
+    /// }
+    ///
+    /// let server = WebServer::new(5, Debug::False);
+    /// server.add_async_listener(Method::get("/slow"), slow);
+    /// ```
+    ///
+    /// # Panics
+    ///
+    /// - If the `method` is already registered.
+    pub fn add_async_listener(
+        &mut self,
+        method: Method,
+        listener: AsyncListener,
+    ) -> &mut WebServer {
+        assert!(
+            !self.listeners.contains_key(&method),
+            "A listener is always registered for {}",
+            method,
+        );
+
+        self.listeners.insert(method, Route::Async(listener));
+
+        self
+    }
+
+    /// Set the pool executing the listeners of [`Lane::Blocking`].
+    ///
+    /// Without this pool, the blocking listeners are executed by the workers of
+    /// the server, like the fast ones.
+    ///
+    /// # Parameters
+    ///
+    /// - `workers`: The pool, sized independently of the workers of the server.
+    ///
+    /// # Returns
+    ///
+    /// Returns the mutable reference to the current instance of [`WebServer`].
+    ///
+    /// # Examples
+    ///
+    /// ```rust
+    /// use std::num::NonZeroUsize;
+    ///
+    /// use crate::server::{Debug, WebServer};
+    /// use crate::threads::WorkerPool;
+    ///
+    /// let server = WebServer::new(5, Debug::False);
+    /// server.set_blocking_pool(WorkerPool::new(NonZeroUsize::new(8).unwrap()));
+    /// ```
+    pub fn set_blocking_pool(&mut self, workers: WorkerPool) -> &mut WebServer {
+        self.blocking = Some(workers);
+
+        self
+    }
+
+    /// Restart the server without refusing any connection, through the control
+    /// socket at `path`, cf.[`Handoff`].
+    ///
+    /// At its start, the server takes the listening socket of the server running
+    /// with the same `path`, which stops accepting and drains. Then it waits the
+    /// next server on the `path`, to give it its listening socket in turn.
+    ///
+    /// # Returns
+    ///
+    /// Returns the mutable reference to the current instance of [`WebServer`].
+    ///
+    /// # Examples
+    ///
+    /// ```rust
+    /// use crate::server::{Debug, WebServer};
+    ///
+    /// let server = WebServer::new(5, Debug::False);
+    /// server.set_handoff("/run/web-server.sock");
+    ///
+    /// // Start the same server again to replace this one.
+    /// server.serve();
+    /// ```
+    pub fn set_handoff(&mut self, path: impl AsRef<Path>) -> &mut WebServer {
+        self.handoff = Some(Handoff::new(path));
+
+        self
+    }
+
+    /// Set the `endpoints` on which the server listens, instead of
+    /// `127.0.0.1:8000`: TCP addresses, or Unix domain sockets with the mode of
+    /// their file, cf.[`Endpoint`].
+    ///
+    /// All endpoints are served by the same reactor and workers.
+    ///
+    /// # Returns
+    ///
+    /// Returns the mutable reference to the current instance of [`WebServer`].
+    ///
+    /// # Panics
+    ///
+    /// - If there is no endpoint, or more than [`Reactor::MAX_LISTENERS`].
+    ///
+    /// # Examples
+    ///
+    /// ```rust
+    /// use std::net::{Ipv4Addr, SocketAddrV4};
+    ///
+    /// use crate::server::{Debug, Endpoint, WebServer};
+    ///
+    /// let server = WebServer::new(5, Debug::False);
+    /// server.set_endpoints([
+    ///     Endpoint::tcp(SocketAddrV4::new(Ipv4Addr::LOCALHOST, 8000)),
+    ///     Endpoint::unix("/run/web-server/http.sock").with_mode(0o660),
+    /// ]);
+    ///
+    /// server.serve();
+    /// ```
+    pub fn set_endpoints(
+        &mut self,
+        endpoints: impl IntoIterator<Item = Endpoint>,
+    ) -> &mut WebServer {
+        let endpoints: Vec<Endpoint> = endpoints.into_iter().collect();
+        assert!(
+            (1..=Reactor::MAX_LISTENERS).contains(&endpoints.len()),
+            "The server needs between 1 and {} endpoints",
+            Reactor::MAX_LISTENERS,
+        );
+        self.endpoints = endpoints;
+
+        self
+    }
+
+    /// Set the deadlines of the connections, cf.[`Timeouts`].
+    ///
+    /// # Returns
+    ///
+    /// Returns the mutable reference to the current instance of [`WebServer`].
+    ///
+    /// # Examples
+    ///
+    /// ```rust
+    /// use std::time::Duration;
+    ///
+    /// use crate::server::{Debug, Timeouts, WebServer};
+    ///
+    /// let server = WebServer::new(5, Debug::False);
+    /// server.set_timeouts(Timeouts::default().with_header(Duration::from_secs(5)));
+    /// ```
+    pub fn set_timeouts(&mut self, timeouts: Timeouts) -> &mut WebServer {
+        self.timeouts = timeouts;
+
+        self
+    }
+
+    /// Execute the server and process incoming requests on its endpoints,
+    /// `127.0.0.1:8000` by default, cf.[`WebServer::set_endpoints()`].
+    ///
+    /// The listening sockets are inherited from the service manager, like with
+    /// the socket activation of `systemd`, else they are taken from the running
+    /// server, cf.[`WebServer::set_handoff()`], else they are bound.
+    ///
+    /// At `Ctrl+C`, or once the listening sockets are handed over to the next
+    /// server, the server drains: it stops accepting, lets the in-flight
+    /// requests end during the drain deadline of its [`Timeouts`], then closes
+    /// the remaining connections and stops the workers. The workers cannot be
+    /// reused after.
     ///
     /// # Examples
     ///
@@ -136,27 +465,49 @@ impl WebServer {
     ///
     /// # Panics
     ///
-    /// - If it is not possible to bind the [`TcpListener`] to `127.0.0.1:8000`,
-    /// cf.[`TcpListener::bind()`].
-    /// - If the [`TcpListener`] cannot enter into the non-blocking mode,
-    /// cf.[`TcpListener::set_nonblocking()`].
-    /// - If [`TcpListener::local_addr()`] fails.
+    /// - If it is not possible to bind an endpoint, cf.[`Endpoint::bind()`].
+    /// - If the control socket of the handoff cannot be created,
+    /// cf.[`Handoff::listen()`].
+    /// - If the [`Reactor`] cannot be created, cf.[`Reactor::new()`].
+    /// - If [`Listener::local_addr()`] fails.
     /// - If [`ctrlc::set_handler()`] fails.
     /// - If the state `is_running` cannot be locked.
-    /// - If the incoming [`TcpStream`] fails.
-    /// - If the incoming [`TcpStream`] cannot enter into the blocking mode.
+    /// - If the [`Reactor`] fails to wait the incoming connections,
+    /// cf.[`Reactor::turn()`].
     /// - If the process of the incoming stream, panics.
     pub fn serve(&mut self) {
-        let listener = TcpListener::bind(SocketAddrV4::new(Ipv4Addr::LOCALHOST, 8000)).unwrap();
-        listener
-            .set_nonblocking(true)
-            .expect("Cannot make the TCP listener to non-blocking mode.");
+        let listeners = self.listen();
+        self.serve_listeners(listeners);
+    }
+
+    /// Execute the server and process incoming requests on the `listeners`,
+    /// like [`WebServer::serve()`].
+    ///
+    /// It is used by the processes of a [`Master`], serving on the listening
+    /// sockets bound by the master.
+    ///
+    /// # Panics
+    ///
+    /// - Same as [`WebServer::serve()`], except the bind.
+    ///
+    /// [`Master`]: crate::master::Master
+    pub fn serve_listeners(&mut self, listeners: Vec<Listener>) {
+        if let Some(handoff) = self.handoff.as_mut() {
+            handoff
+                .listen()
+                .expect("Cannot listen on the control socket of the handoff.");
+        }
+
+        let mut reactor =
+            Reactor::new(listeners, self.timeouts).expect("Cannot create the reactor.");
 
         let is_running = Arc::new(Mutex::new(true));
-        println!(
-            "Server started and waiting for incoming connections on {}.",
-            listener.local_addr().unwrap(),
-        );
+        for listener in reactor.listeners() {
+            info!(
+                address = listener.local_addr().unwrap(), workers = self.workers.size();
+                "Server started and waiting for incoming connections.",
+            );
+        }
 
         let cloned_is_running = Arc::clone(&is_running);
         ctrlc::set_handler(move || {
@@ -164,50 +515,211 @@ impl WebServer {
         })
         .expect("Cannot set handler for ctrl+c");
 
+        let mut requests = Vec::new();
         while *(is_running.lock().expect("Cannot lock 'is_running'")) {
-            let stream = listener.accept();
-
-            match stream {
-                Err(ref e) if e.kind() == WouldBlock => {}
-                Ok((stream, _)) => {
-                    stream
-                        .set_nonblocking(false)
-                        .expect("Cannot make the TCP stream to blocking mode.");
-                    self.handle(stream);
+            reactor
+                .turn(Self::SHUTDOWN_CHECK_INTERVAL, &mut requests)
+                .expect("Cannot wait the incoming connections.");
+
+            for request in requests.drain(..) {
+                self.handle(request, &mut reactor);
+            }
+
+            if self.hand_over(&reactor) {
+                break;
+            }
+        }
+
+        let deadline = Instant::now() + self.timeouts.drain();
+        self.drain(&mut reactor, deadline);
+        drop(reactor);
+
+        let deadline = deadline.max(Instant::now() + Self::CANCELLATION_GRACE);
+        self.workers.shutdown(deadline);
+        if let Some(blocking) = self.blocking.as_mut() {
+            blocking.shutdown(deadline);
+        }
+    }
+
+    /// Get the listening sockets: inherited from the service manager, received
+    /// from the running server, or bound on the endpoints.
+    ///
+    /// # Panics
+    ///
+    /// - If it is not possible to bind an endpoint, cf.[`Endpoint::bind()`].
+    #[doc(hidden)]
+    fn listen(&self) -> Vec<Listener> {
+        let inherited = sockets::inherited();
+        if !inherited.is_empty() {
+            info!(listeners = inherited.len(); "Listeners inherited from the service manager.");
+            return inherited.into_iter().map(Listener::from).collect();
+        }
+
+        if let Some(handoff) = &self.handoff {
+            match handoff.receive() {
+                Ok(sockets) if !sockets.is_empty() => {
+                    info!(path = handoff.path().display(), listeners = sockets.len(); "Listeners received from the running server.");
+                    return sockets.into_iter().map(Listener::from).collect();
+                }
+                Ok(_) => {}
+                Err(error) => {
+                    warning!(error = error; "Listeners not received from the running server.")
                 }
-                Err(error) => panic!("encountered IO error: {}", error),
+            }
+        }
+
+        self.endpoints
+            .iter()
+            .map(|endpoint| {
+                endpoint
+                    .bind()
+                    .unwrap_or_else(|error| panic!("Cannot bind {}: {error}", endpoint.address()))
+            })
+            .collect()
+    }
+
+    /// Give the listening sockets of the `reactor` to the next server, if it is
+    /// waiting on the control socket.
+    ///
+    /// # Returns
+    ///
+    /// Returns `true` if the sockets are handed over, so the server must drain.
+    #[doc(hidden)]
+    fn hand_over(&mut self, reactor: &Reactor) -> bool {
+        let Some(handoff) = self.handoff.as_mut() else {
+            return false;
+        };
+        if reactor.listeners().is_empty() {
+            return false;
+        }
+
+        let sockets: Vec<_> = reactor.listeners().iter().map(AsFd::as_fd).collect();
+        match handoff.poll(&sockets) {
+            Ok(handed_over) => {
+                if handed_over {
+                    info!("Listeners handed over to the next server.");
+                }
+                handed_over
+            }
+            Err(error) => {
+                warning!(error = error; "Listeners not handed over to the next server.");
+                false
             }
         }
     }
 
-    /// Process the incoming [`TcpStream`].
+    /// Stop accepting, and process the events of the `reactor` until its
+    /// connections are closed or the `deadline`.
+    ///
+    /// The requests already received are still processed. At the `deadline`, the
+    /// remaining connections are closed by the drop of the `reactor`, and their
+    /// listeners are cancelled.
     ///
     /// # Panics
     ///
-    /// - If the creation of [`Request`] from the stream, panics.
-    /// cf.[`Request::from_stream()`].
-    /// - If the execution of the request, panics.
-    /// cf.[`WorkerPool::execute()`].
+    /// - If the [`Reactor`] fails to wait the events, cf.[`Reactor::turn()`].
     #[doc(hidden)]
-    fn handle(&mut self, stream: TcpStream) {
-        let request = Request::from(stream);
+    fn drain(&mut self, reactor: &mut Reactor, deadline: Instant) {
+        let mut requests = Vec::new();
+        reactor
+            .stop_accepting(&mut requests)
+            .expect("Cannot stop accepting the connections.");
+        info!(connections = reactor.connections(); "Server stopped accepting; draining.");
+
+        loop {
+            for request in requests.drain(..) {
+                self.handle(request, reactor);
+            }
 
+            let now = Instant::now();
+            if reactor.is_idle() || now >= deadline {
+                break;
+            }
+
+            let max_wait = (deadline - now).min(Self::SHUTDOWN_CHECK_INTERVAL);
+            reactor
+                .turn(max_wait, &mut requests)
+                .expect("Cannot wait the events of the connections.");
+        }
+
+        if !reactor.is_idle() {
+            warning!(
+                connections = reactor.connections(), tasks = reactor.tasks();
+                "Drain deadline exceeded; closing the remaining connections.",
+            );
+        }
+    }
+
+    /// Process the incoming [`Request`], whose head is read by the `reactor`.
+    ///
+    /// The asynchronous listeners are spawned on the `reactor`. If the queues of
+    /// the workers are full, the request is not queued but rejected at once,
+    /// cf.[`Response::reject_unavailable()`].
+    ///
+    /// # Panics
+    ///
+    /// - If the queues of the workers are closed.
+    /// cf.[`WorkerPool::try_execute()`].
+    #[doc(hidden)]
+    fn handle(&mut self, request: Request, reactor: &mut Reactor) {
         if self.debug {
-            println!("Request {}: {request:#?}", self.cpt);
+            debug!(request = self.cpt; "{request:?}");
         }
         self.cpt += 1;
 
-        let listener = self
-            .listeners
-            .get(request.method())
-            .unwrap_or(&(Self::not_found_handler as HTTPListener));
+        let (listener, lane) = match self.listeners.get(request.method()).copied() {
+            Some(Route::Sync(listener, lane)) => (listener, lane),
+            Some(Route::Async(listener)) => {
+                // The request is consumed by the listener, so a duplicate of its
+                // stream is kept to reject it after its deadline.
+                let stream = request.try_clone_stream().ok();
+                let deadline = self.timeouts.handler();
+                let cancellation = request.cancellation();
 
-        self.workers
-            .execute(Job {
-                request,
-                listener: *listener,
-            })
-            .unwrap();
+                reactor.spawn(async move {
+                    match timeout(deadline, cancellable(cancellation, listener(request))).await {
+                        Some(Some(mut response)) => {
+                            if let Err(error) = response.send() {
+                                warning!(error = error; "Cannot send the response.");
+                            }
+                        }
+                        // The client is gone, the listener is dropped.
+                        Some(None) => debug!("Asynchronous request cancelled by its client."),
+                        None => {
+                            warning!(deadline_ms = deadline.as_millis(); "Asynchronous request exceeded its deadline.");
+                            if let Some(stream) = stream {
+                                let _ = Response::reject_unavailable_stream(stream);
+                            }
+                        }
+                    }
+                });
+
+                return;
+            }
+            None => (Self::not_found_handler as HTTPListener, Lane::Fast),
+        };
+
+        let workers = match (lane, self.blocking.as_mut()) {
+            (Lane::Blocking, Some(blocking)) => blocking,
+            _ => &mut self.workers,
+        };
+
+        match workers.try_execute(Job::new(request, listener)) {
+            Ok(()) => {}
+            Err(PushError::Full(job)) => {
+                warning!(request = self.cpt - 1; "Request rejected: all workers are busy.");
+
+                let _ = Response::reject_unavailable(job.request);
+            }
+            Err(error) => panic!("{error}"),
+        }
+
+        for event in self.workers.scaling_events() {
+            info!("{event}");
+        }
+        for event in self.blocking.iter().flat_map(WorkerPool::scaling_events) {
+            info!(lane = "blocking"; "{event}");
+        }
     }
 
     /// Process the incoming [`Request`] if any listener is registered for the
@@ -233,7 +745,7 @@ impl WebServer {
 }
 
 impl Default for WebServer {
-    /// Create the [`WebServer`] with one worker
+    /// Create the [`WebServer`] with one worker per usable CPU
     /// and the [`enum@Debug`] to false.
     ///
     /// # Returns
@@ -248,10 +760,36 @@ impl Default for WebServer {
     /// let server = WebServer::default();
     /// ```
     fn default() -> Self {
-        Self::new(NonZeroUsize::new(1).unwrap(), Debug::default())
+        Self::new(Affinity::available_parallelism(), Debug::default())
     }
 }
 
+/// The listener of a registered route.
+#[derive(Debug, Clone, Copy)]
+#[doc(hidden)]
+enum Route {
+    /// The listener is executed by a pool of workers.
+    Sync(HTTPListener, Lane),
+
+    /// The listener is executed by the reactor.
+    Async(AsyncListener),
+}
+
+/// The pool executing the listener of a route, cf.[`WebServer::add_listener_on()`].
+///
+/// The blocking listeners are executed by their own pool, so the slow routes
+/// cannot occupy all workers of the fast routes.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, Default)]
+pub enum Lane {
+    /// The listener answers quickly, on the workers of the server.
+    #[default]
+    Fast,
+
+    /// The listener blocks for a long time, on the pool set with
+    /// [`WebServer::set_blocking_pool()`].
+    Blocking,
+}
+
 /// Indicate if the debug mode is activated on the [`WebServer`].
 #[derive(Debug, Clone, PartialEq, Eq, Default)]
 pub enum Debug {
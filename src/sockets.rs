@@ -0,0 +1,33 @@
+//! Module giving the sockets of the server: the [`Endpoint`] binding a
+//! [`Listener`], TCP or Unix domain, with its tuning, the [`Stream`] of its
+//! connections, the sockets inherited from a service manager, and the
+//! [`Handoff`] of the sockets between two processes of the server, for a
+//! restart without refused connections.
+//!
+//! To use it, go to the documentation of [`Endpoint`], [`inherited()`] and
+//! [`Handoff`].
+
+pub use self::activation::inherited;
+pub use self::endpoint::{Endpoint, KeepAlive};
+pub use self::handoff::Handoff;
+pub use self::listener::{Address, Listener};
+pub use self::stream::Stream;
+
+/// Module contains the sockets [`inherited()`] from a service manager, like
+/// `systemd`.
+mod activation;
+
+/// Module contains the [`Endpoint`] of the server.
+mod endpoint;
+
+/// Module contains the [`Handoff`] of the listening sockets.
+mod handoff;
+
+/// Module contains the [`Listener`] and its [`Address`].
+mod listener;
+
+/// Module contains the options of the sockets.
+mod options;
+
+/// Module contains the [`Stream`] of a connection.
+mod stream;
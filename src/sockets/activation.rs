@@ -0,0 +1,83 @@
+use std::env;
+use std::os::fd::{FromRawFd, OwnedFd, RawFd};
+use std::sync::atomic::{AtomicBool, Ordering};
+
+/// The first descriptor passed by the service manager.
+#[doc(hidden)]
+const FIRST_DESCRIPTOR: RawFd = 3;
+
+/// Indicate if the inherited sockets are already taken.
+#[doc(hidden)]
+static TAKEN: AtomicBool = AtomicBool::new(false);
+
+/// Take the listening sockets passed by the service manager, with the protocol
+/// of the socket activation of `systemd`.
+///
+/// The manager opens the sockets before starting the process, so the
+/// connections wait in their backlog during a restart instead of being
+/// refused. The sockets are the descriptors from `3`, their amount is in
+/// `LISTEN_FDS`, and `LISTEN_PID` is the process receiving them.
+///
+/// The sockets are marked close-on-exec, and the variables are removed from the
+/// environment, so a child process does not hold nor take them.
+///
+/// # Returns
+///
+/// Returns the inherited sockets, in the order of the manager, or nothing if
+/// the variables are missing or are for another process, or if the sockets are
+/// already taken.
+///
+/// # Examples
+///
+/// ```rust
+/// use std::net::TcpListener;
+///
+/// use crate::sockets::inherited;
+///
+/// let listener = match inherited().into_iter().next() {
+///     Some(socket) => TcpListener::from(socket),
+///     None => TcpListener::bind("127.0.0.1:8000").unwrap(),
+/// };
+/// ```
+pub fn inherited() -> Vec<OwnedFd> {
+    let pid = env::var("LISTEN_PID").ok();
+    let amount = env::var("LISTEN_FDS").ok();
+
+    // The variables are removed, like `sd_listen_fds(1)`, so the child processes
+    // do not take them.
+    for variable in ["LISTEN_PID", "LISTEN_FDS", "LISTEN_FDNAMES"] {
+        env::remove_var(variable);
+    }
+
+    let for_this_process = pid
+        .and_then(|pid| pid.parse::<u32>().ok())
+        .is_some_and(|pid| pid == std::process::id());
+    if !for_this_process || TAKEN.swap(true, Ordering::AcqRel) {
+        return Vec::new();
+    }
+
+    let amount = amount
+        .and_then(|amount| amount.parse::<RawFd>().ok())
+        .unwrap_or_default();
+
+    (FIRST_DESCRIPTOR..FIRST_DESCRIPTOR.saturating_add(amount))
+        .filter(|&fd| set_cloexec(fd))
+        // SAFETY: The manager gives the open descriptors to this process only,
+        // and they are taken once.
+        .map(|fd| unsafe { OwnedFd::from_raw_fd(fd) })
+        .collect()
+}
+
+/// Mark the `fd` close-on-exec.
+///
+/// # Returns
+///
+/// Returns `false` if the `fd` is not open.
+#[doc(hidden)]
+fn set_cloexec(fd: RawFd) -> bool {
+    // SAFETY: The command only changes the flags of the descriptor.
+    let flags = unsafe { libc::fcntl(fd, libc::F_GETFD) };
+
+    // SAFETY: Same as above.
+    flags != -1 && unsafe { libc::fcntl(fd, libc::F_SETFD, flags | libc::FD_CLOEXEC) } != -1
+}
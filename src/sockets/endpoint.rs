@@ -0,0 +1,427 @@
+use std::fs;
+use std::io::{self, ErrorKind};
+use std::net::{SocketAddr, TcpListener};
+use std::num::NonZeroU32;
+use std::os::unix::fs::FileTypeExt;
+use std::os::unix::net::UnixStream;
+use std::path::Path;
+use std::time::Duration;
+
+use super::{options, Address, Listener};
+
+/// The address on which the server listens: a TCP address, or the path of a
+/// Unix domain socket.
+///
+/// A Unix domain socket avoids the TCP/IP stack and the ephemeral ports for the
+/// clients on the same host, like a local reverse proxy. The mode of its file
+/// controls which users can connect.
+///
+/// Each endpoint has its own tuning: the length of its backlog, and for TCP,
+/// the deferred accept, the fast open, the keep-alive probes and the busy
+/// polling of its connections. The options of TCP are ignored for a Unix domain socket, and
+/// the options not supported by the system are ignored.
+///
+/// By default, a TCP endpoint defers the accept until the request arrives, and
+/// accepts the fast open, cf.[`Endpoint::DEFAULT_DEFER_ACCEPT`] and
+/// [`Endpoint::DEFAULT_FAST_OPEN`].
+///
+/// # How to use it?
+///
+/// ```rust
+/// use std::net::{Ipv4Addr, SocketAddrV4};
+/// use std::num::NonZeroU32;
+/// use std::time::Duration;
+///
+/// use crate::sockets::{Endpoint, KeepAlive};
+///
+/// // The public port, behind a load balancer.
+/// let external = Endpoint::tcp(SocketAddrV4::new(Ipv4Addr::UNSPECIFIED, 8080))
+///     .with_backlog(NonZeroU32::new(4096).unwrap())
+///     .with_defer_accept(Duration::from_secs(10))
+///     .with_fast_open(NonZeroU32::new(1024).unwrap())
+///     .with_keep_alive(KeepAlive::default());
+///
+/// // The port of the health checks, opening empty connections.
+/// let internal = Endpoint::tcp(SocketAddrV4::new(Ipv4Addr::LOCALHOST, 8000))
+///     .without_defer_accept()
+///     .without_fast_open();
+/// let unix = Endpoint::unix("/run/web-server/http.sock").with_mode(0o660);
+///
+/// let listener = unix.bind().unwrap();
+/// ```
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct Endpoint {
+    #[doc(hidden)]
+    address: Address,
+    #[doc(hidden)]
+    mode: u32,
+    #[doc(hidden)]
+    backlog: NonZeroU32,
+    #[doc(hidden)]
+    defer_accept: Option<Duration>,
+    #[doc(hidden)]
+    fast_open: Option<NonZeroU32>,
+    #[doc(hidden)]
+    keep_alive: Option<KeepAlive>,
+    #[doc(hidden)]
+    busy_poll: Option<Duration>,
+}
+
+impl Endpoint {
+    /// The default mode of the file of a Unix domain socket: the owner and its
+    /// group can connect.
+    pub const DEFAULT_MODE: u32 = 0o660;
+
+    /// The default length of the backlog, the one of the standard library.
+    pub const DEFAULT_BACKLOG: u32 = 128;
+
+    /// The default maximal wait of the first bytes of a request before the
+    /// accept. Then the connection is accepted anyway, and the deadline of its
+    /// head applies.
+    pub const DEFAULT_DEFER_ACCEPT: Duration = Duration::from_secs(5);
+
+    /// The default amount of connections waiting their handshake with data.
+    pub const DEFAULT_FAST_OPEN: u32 = 256;
+
+    /// Create the endpoint of the TCP `address`, with the
+    /// [`Endpoint::DEFAULT_DEFER_ACCEPT`] and the [`Endpoint::DEFAULT_FAST_OPEN`].
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Endpoint`].
+    pub fn tcp(address: impl Into<SocketAddr>) -> Endpoint {
+        Self::new(Address::Tcp(address.into()))
+    }
+
+    /// Create the endpoint of the Unix domain socket at `path`, with the
+    /// [`Endpoint::DEFAULT_MODE`].
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Endpoint`].
+    pub fn unix(path: impl AsRef<Path>) -> Endpoint {
+        Self::new(Address::Unix(path.as_ref().to_path_buf()))
+    }
+
+    /// Create the endpoint of the `address`, with the default tuning.
+    #[doc(hidden)]
+    fn new(address: Address) -> Endpoint {
+        Self {
+            address,
+            mode: Self::DEFAULT_MODE,
+            backlog: NonZeroU32::new(Self::DEFAULT_BACKLOG).unwrap(),
+            defer_accept: Some(Self::DEFAULT_DEFER_ACCEPT),
+            fast_open: NonZeroU32::new(Self::DEFAULT_FAST_OPEN),
+            keep_alive: None,
+            busy_poll: None,
+        }
+    }
+
+    /// Set the `mode` of the file of a Unix domain socket, like `0o660`.
+    ///
+    /// It is ignored for a TCP address.
+    ///
+    /// # Returns
+    ///
+    /// Returns the instance of [`Endpoint`] with the mode.
+    ///
+    /// # Panics
+    ///
+    /// - If the `mode` has other bits than the permissions.
+    pub fn with_mode(mut self, mode: u32) -> Endpoint {
+        assert_eq!(
+            mode & !0o777,
+            0,
+            "The mode can only have the permission bits"
+        );
+        self.mode = mode;
+
+        self
+    }
+
+    /// Set the length of the `backlog`: the connections not accepted yet, beyond
+    /// which the clients are refused. The system can cap it, like with
+    /// `net.core.somaxconn` on Linux.
+    ///
+    /// # Returns
+    ///
+    /// Returns the instance of [`Endpoint`] with the backlog.
+    pub fn with_backlog(mut self, backlog: NonZeroU32) -> Endpoint {
+        self.backlog = backlog;
+
+        self
+    }
+
+    /// Accept a TCP connection only once the first bytes of its request
+    /// arrived, waiting them at most the `timeout`, with `TCP_DEFER_ACCEPT` on
+    /// Linux.
+    ///
+    /// The reactor is not woken up by the connections staying empty, and does
+    /// not hold them while it waits their head.
+    ///
+    /// # Returns
+    ///
+    /// Returns the instance of [`Endpoint`] with the deferred accept.
+    ///
+    /// # Panics
+    ///
+    /// - If the `timeout` is less than one second, the resolution of the option.
+    pub fn with_defer_accept(mut self, timeout: Duration) -> Endpoint {
+        assert!(
+            timeout >= Duration::from_secs(1),
+            "The timeout of the deferred accept must be at least one second"
+        );
+        self.defer_accept = Some(timeout);
+
+        self
+    }
+
+    /// Accept the TCP connections as soon as their handshake ends, like for
+    /// the clients opening them in advance.
+    ///
+    /// # Returns
+    ///
+    /// Returns the instance of [`Endpoint`] without the deferred accept.
+    pub fn without_defer_accept(mut self) -> Endpoint {
+        self.defer_accept = None;
+
+        self
+    }
+
+    /// Accept the data in the opening of the TCP connections of the returning
+    /// clients, with `TCP_FASTOPEN`, so they save a round trip. At most `queue`
+    /// connections wait their handshake with data.
+    ///
+    /// On Linux, the server side must also be enabled in the system, with the
+    /// bit `2` of `net.ipv4.tcp_fastopen`.
+    ///
+    /// # Returns
+    ///
+    /// Returns the instance of [`Endpoint`] with the fast open.
+    pub fn with_fast_open(mut self, queue: NonZeroU32) -> Endpoint {
+        self.fast_open = Some(queue);
+
+        self
+    }
+
+    /// Refuse the data in the opening of the TCP connections.
+    ///
+    /// # Returns
+    ///
+    /// Returns the instance of [`Endpoint`] without the fast open.
+    pub fn without_fast_open(mut self) -> Endpoint {
+        self.fast_open = None;
+
+        self
+    }
+
+    /// Probe the idle TCP connections with the [`KeepAlive`] policy, to close
+    /// the ones whose client is gone without closing them.
+    ///
+    /// # Returns
+    ///
+    /// Returns the instance of [`Endpoint`] with the keep-alive policy.
+    pub fn with_keep_alive(mut self, keep_alive: KeepAlive) -> Endpoint {
+        self.keep_alive = Some(keep_alive);
+
+        self
+    }
+
+    /// Poll the device queue during at most `timeout` on a read without data,
+    /// instead of waiting the interrupt, with `SO_BUSY_POLL` on Linux. It
+    /// lowers the latency for a CPU cost.
+    ///
+    /// Raising it above `net.core.busy_read` needs the capability
+    /// `CAP_NET_ADMIN`, else it is ignored. The waits of the reactor poll the
+    /// device with `net.core.busy_poll`. For the busy polling of the workers,
+    /// cf.[`BusyPoll`].
+    ///
+    /// # Returns
+    ///
+    /// Returns the instance of [`Endpoint`] with the busy polling.
+    ///
+    /// <!-- References -->
+    ///
+    /// [`BusyPoll`]: crate::threads::BusyPoll
+    pub fn with_busy_poll(mut self, timeout: Duration) -> Endpoint {
+        self.busy_poll = Some(timeout);
+
+        self
+    }
+
+    /// Get the address of the endpoint.
+    pub fn address(&self) -> &Address {
+        &self.address
+    }
+
+    /// Bind the listening socket of the endpoint.
+    ///
+    /// The file left by a stopped server at the path of a Unix domain socket is
+    /// replaced, but not the one of a running server.
+    ///
+    /// # Returns
+    ///
+    /// Returns the [`Listener`], or the error of the system.
+    pub fn bind(&self) -> io::Result<Listener> {
+        let backlog = libc::c_int::try_from(self.backlog.get()).unwrap_or(libc::c_int::MAX);
+
+        match &self.address {
+            Address::Tcp(address) => {
+                let listener = TcpListener::bind(address)?;
+                self.tune(&listener);
+                options::listen(&listener, backlog)?;
+
+                Ok(Listener::Tcp(listener))
+            }
+            Address::Unix(path) => {
+                remove_stale(path)?;
+
+                // The mode is set before the listen, so no client connects before.
+                let listener = options::bind_unix(path, self.mode, backlog)?;
+
+                Ok(Listener::Unix(listener))
+            }
+        }
+    }
+
+    /// Set the options of TCP of the `listener`, inherited by its connections.
+    ///
+    /// An option not supported by the system is ignored.
+    #[doc(hidden)]
+    fn tune(&self, listener: &TcpListener) {
+        #[cfg(target_os = "linux")]
+        if let Some(timeout) = self.defer_accept {
+            let seconds = libc::c_int::try_from(timeout.as_secs()).unwrap_or(libc::c_int::MAX);
+            let _ = options::set(listener, libc::IPPROTO_TCP, libc::TCP_DEFER_ACCEPT, seconds);
+        }
+
+        #[cfg(any(target_os = "linux", target_os = "macos", target_os = "freebsd"))]
+        if let Some(queue) = self.fast_open {
+            let queue = libc::c_int::try_from(queue.get()).unwrap_or(libc::c_int::MAX);
+            let _ = options::set(listener, libc::IPPROTO_TCP, libc::TCP_FASTOPEN, queue);
+        }
+
+        if let Some(keep_alive) = self.keep_alive {
+            keep_alive.apply(listener);
+        }
+
+        #[cfg(target_os = "linux")]
+        if let Some(timeout) = self.busy_poll {
+            let micros = libc::c_int::try_from(timeout.as_micros()).unwrap_or(libc::c_int::MAX);
+            let _ = options::set(listener, libc::SOL_SOCKET, libc::SO_BUSY_POLL, micros);
+        }
+    }
+}
+
+/// The policy of the keep-alive probes of the idle TCP connections.
+///
+/// After the `idle` duration without traffic, the system sends a probe every
+/// `interval`, and closes the connection after `retries` probes without
+/// answer.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct KeepAlive {
+    #[doc(hidden)]
+    idle: Duration,
+    #[doc(hidden)]
+    interval: Duration,
+    #[doc(hidden)]
+    retries: NonZeroU32,
+}
+
+impl KeepAlive {
+    /// Create the keep-alive policy.
+    ///
+    /// # Parameters
+    ///
+    /// - `idle`: The duration without traffic before the first probe.
+    /// - `interval`: The duration between two probes.
+    /// - `retries`: The amount of probes without answer closing the connection.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`KeepAlive`].
+    ///
+    /// # Panics
+    ///
+    /// - If `idle` or `interval` is less than one second, the resolution of the
+    /// options.
+    pub fn new(idle: Duration, interval: Duration, retries: NonZeroU32) -> KeepAlive {
+        assert!(
+            idle >= Duration::from_secs(1) && interval >= Duration::from_secs(1),
+            "The durations of the keep-alive must be at least one second"
+        );
+
+        Self {
+            idle,
+            interval,
+            retries,
+        }
+    }
+
+    /// Enable the probes on the `listener`, with the durations and the retries
+    /// where the system supports them.
+    #[doc(hidden)]
+    fn apply(&self, listener: &TcpListener) {
+        let _ = options::set(listener, libc::SOL_SOCKET, libc::SO_KEEPALIVE, 1);
+
+        #[cfg(target_os = "linux")]
+        {
+            let seconds = |duration: Duration| {
+                libc::c_int::try_from(duration.as_secs()).unwrap_or(libc::c_int::MAX)
+            };
+            let retries = libc::c_int::try_from(self.retries.get()).unwrap_or(libc::c_int::MAX);
+
+            let _ = options::set(
+                listener,
+                libc::IPPROTO_TCP,
+                libc::TCP_KEEPIDLE,
+                seconds(self.idle),
+            );
+            let _ = options::set(
+                listener,
+                libc::IPPROTO_TCP,
+                libc::TCP_KEEPINTVL,
+                seconds(self.interval),
+            );
+            let _ = options::set(listener, libc::IPPROTO_TCP, libc::TCP_KEEPCNT, retries);
+        }
+    }
+}
+
+impl Default for KeepAlive {
+    /// Create the keep-alive policy closing a dead connection after about two
+    /// minutes: idle `60s`, interval `10s`, `6` retries.
+    fn default() -> Self {
+        Self::new(
+            Duration::from_secs(60),
+            Duration::from_secs(10),
+            NonZeroU32::new(6).unwrap(),
+        )
+    }
+}
+
+/// Remove the Unix domain socket at `path` if no server listens on it.
+///
+/// # Returns
+///
+/// Returns [`ErrorKind::AddrInUse`] if a server listens on it, or another error
+/// of the system, or nothing if the path is free.
+#[doc(hidden)]
+fn remove_stale(path: &Path) -> io::Result<()> {
+    match fs::symlink_metadata(path) {
+        Ok(metadata) if metadata.file_type().is_socket() => {}
+        // The bind reports the other files.
+        Ok(_) => return Ok(()),
+        Err(error) if error.kind() == ErrorKind::NotFound => return Ok(()),
+        Err(error) => return Err(error),
+    }
+
+    match UnixStream::connect(path) {
+        Ok(_) => Err(io::Error::new(
+            ErrorKind::AddrInUse,
+            format!("A server listens on {}", path.display()),
+        )),
+        Err(error) if error.kind() == ErrorKind::ConnectionRefused => fs::remove_file(path),
+        Err(error) => Err(error),
+    }
+}
@@ -0,0 +1,332 @@
+use std::fs;
+use std::io::{self, ErrorKind};
+use std::os::fd::{AsRawFd, BorrowedFd, FromRawFd, OwnedFd, RawFd};
+use std::os::unix::fs::MetadataExt;
+use std::os::unix::net::{UnixListener, UnixStream};
+use std::path::{Path, PathBuf};
+use std::time::Duration;
+
+use super::options;
+use crate::logging::warning;
+
+/// The handoff of the listening sockets from a running process of the server to
+/// the next one, through a Unix socket.
+///
+/// The running process listens on the control socket at the path. The next
+/// process connects to it, and receives the listening sockets with
+/// `SCM_RIGHTS`: both processes share the same sockets, so no connection is
+/// refused and no port is rebound. The running process then stops accepting and
+/// drains, while the next one accepts and takes over the control socket.
+///
+/// # How to use it?
+///
+/// ```rust
+/// // Logic in the server in `src/server.rs`.
+///
+/// use std::net::TcpListener;
+/// use std::os::fd::AsFd;
+///
+/// use crate::sockets::Handoff;
+///
+/// let mut handoff = Handoff::new("/run/web-server.sock");
+///
+/// // Take the sockets of the running process, if any.
+/// let listener = match handoff.receive().unwrap().into_iter().next() {
+///     Some(socket) => TcpListener::from(socket),
+///     None => TcpListener::bind("127.0.0.1:8000").unwrap(),
+/// };
+///
+/// // Wait the next process.
+/// handoff.listen().unwrap();
+/// loop {
+///     if handoff.poll(&[listener.as_fd()]).unwrap() {
+///         // The next process accepts, drain then end.
+///         break;
+///     }
+/// }
+/// ```
+#[derive(Debug)]
+pub struct Handoff {
+    #[doc(hidden)]
+    path: PathBuf,
+    #[doc(hidden)]
+    control: Option<Control>,
+}
+
+impl Handoff {
+    /// The maximal amount of sockets handed over.
+    pub const MAX_SOCKETS: usize = 16;
+
+    /// The maximal duration of the exchange with the other process.
+    #[doc(hidden)]
+    const EXCHANGE_TIMEOUT: Duration = Duration::from_secs(5);
+
+    /// The mode of the control socket, only its owner can connect.
+    #[doc(hidden)]
+    const MODE: u32 = 0o600;
+
+    /// The backlog of the control socket, one next process at a time.
+    #[doc(hidden)]
+    const BACKLOG: libc::c_int = 1;
+
+    /// Create the handoff through the control socket at `path`.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Handoff`].
+    pub fn new(path: impl AsRef<Path>) -> Handoff {
+        Self {
+            path: path.as_ref().to_path_buf(),
+            control: None,
+        }
+    }
+
+    /// Get the path of the control socket.
+    pub fn path(&self) -> &Path {
+        &self.path
+    }
+
+    /// Receive the listening sockets of the running process.
+    ///
+    /// # Returns
+    ///
+    /// Returns the sockets, or nothing if no process listens on the control
+    /// socket, or the error of the exchange.
+    pub fn receive(&self) -> io::Result<Vec<OwnedFd>> {
+        let stream = match UnixStream::connect(&self.path) {
+            Ok(stream) => stream,
+            // No running process, or a control socket left by a stopped one.
+            Err(error)
+                if matches!(
+                    error.kind(),
+                    ErrorKind::NotFound | ErrorKind::ConnectionRefused
+                ) =>
+            {
+                return Ok(Vec::new())
+            }
+            Err(error) => return Err(error),
+        };
+        stream.set_read_timeout(Some(Self::EXCHANGE_TIMEOUT))?;
+
+        receive_fds(&stream)
+    }
+
+    /// Listen on the control socket for the next process, replacing the control
+    /// socket of the previous one.
+    ///
+    /// The control socket is only accessible by its owner, its mode is set
+    /// before it listens.
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the system, or nothing if all is good.
+    pub fn listen(&mut self) -> io::Result<()> {
+        match fs::remove_file(&self.path) {
+            Err(error) if error.kind() != ErrorKind::NotFound => return Err(error),
+            _ => {}
+        }
+
+        let listener = options::bind_unix(&self.path, Self::MODE, Self::BACKLOG)?;
+        listener.set_nonblocking(true)?;
+
+        let metadata = fs::metadata(&self.path)?;
+        self.control = Some(Control {
+            listener,
+            inode: (metadata.dev(), metadata.ino()),
+        });
+
+        Ok(())
+    }
+
+    /// Give the `sockets` to the next process, if it is connected to the control
+    /// socket. Without waiting.
+    ///
+    /// After a handoff, the control socket is closed: the next process owns its
+    /// path. A process of another user than the effective user of this process is
+    /// refused, without the sockets.
+    ///
+    /// # Returns
+    ///
+    /// Returns `true` if the sockets are handed over, `false` if no process is
+    /// connected or if [`Handoff::listen()`] is not called, or the error of the
+    /// exchange.
+    ///
+    /// # Panics
+    ///
+    /// - If there are more than [`Handoff::MAX_SOCKETS`] `sockets`.
+    pub fn poll(&mut self, sockets: &[BorrowedFd<'_>]) -> io::Result<bool> {
+        assert!(
+            sockets.len() <= Self::MAX_SOCKETS,
+            "Cannot hand over more than {} sockets",
+            Self::MAX_SOCKETS,
+        );
+
+        let Some(control) = &self.control else {
+            return Ok(false);
+        };
+
+        let stream = match control.listener.accept() {
+            Ok((stream, _)) => stream,
+            Err(error) if error.kind() == ErrorKind::WouldBlock => return Ok(false),
+            Err(error) => return Err(error),
+        };
+        // SAFETY: The call has no precondition.
+        let owner = unsafe { libc::geteuid() };
+        match options::peer_uid(&stream) {
+            Ok(uid) if uid == owner => {}
+            Ok(uid) => {
+                warning!(path = self.path.display(), uid = uid; "Handoff refused to another user.");
+                return Ok(false);
+            }
+            Err(error) => return Err(error),
+        }
+
+        stream.set_nonblocking(false)?;
+        stream.set_write_timeout(Some(Self::EXCHANGE_TIMEOUT))?;
+
+        let fds: Vec<RawFd> = sockets.iter().map(AsRawFd::as_raw_fd).collect();
+        send_fds(&stream, &fds)?;
+
+        // The path is now owned by the next process.
+        self.control = None;
+        Ok(true)
+    }
+}
+
+impl Drop for Handoff {
+    /// Remove the control socket, if its path is not taken by the next process.
+    fn drop(&mut self) {
+        let Some(control) = self.control.take() else {
+            return;
+        };
+
+        let owned = fs::metadata(&self.path)
+            .is_ok_and(|metadata| (metadata.dev(), metadata.ino()) == control.inode);
+        if owned {
+            let _ = fs::remove_file(&self.path);
+        }
+    }
+}
+
+/// The control socket of a [`Handoff`].
+#[derive(Debug)]
+#[doc(hidden)]
+struct Control {
+    #[doc(hidden)]
+    listener: UnixListener,
+    /// The device and the inode of the path, to not remove the control socket
+    /// of another process.
+    #[doc(hidden)]
+    inode: (u64, u64),
+}
+
+/// Send the `fds` with `SCM_RIGHTS` on the `stream`, with one byte of data.
+///
+/// # Returns
+///
+/// Returns the error of the system, or nothing if all is good.
+#[doc(hidden)]
+fn send_fds(stream: &UnixStream, fds: &[RawFd]) -> io::Result<()> {
+    let size = std::mem::size_of_val(fds) as u32;
+    // SAFETY: The macro only computes a size.
+    let mut control = vec![0_u64; (unsafe { libc::CMSG_SPACE(size) } as usize).div_ceil(8)];
+
+    let mut byte = [0_u8];
+    let mut iov = libc::iovec {
+        iov_base: byte.as_mut_ptr().cast(),
+        iov_len: byte.len(),
+    };
+
+    // SAFETY: A message header is plain data, valid when zeroed.
+    let mut message: libc::msghdr = unsafe { std::mem::zeroed() };
+    message.msg_iov = &mut iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control.as_mut_ptr().cast();
+    message.msg_controllen = (control.len() * 8) as _;
+
+    // SAFETY: The control buffer is aligned, zeroed and large enough for one
+    // header with the descriptors, and lives during the copy and the call.
+    let sent = unsafe {
+        let header = libc::CMSG_FIRSTHDR(&message);
+        (*header).cmsg_level = libc::SOL_SOCKET;
+        (*header).cmsg_type = libc::SCM_RIGHTS;
+        (*header).cmsg_len = libc::CMSG_LEN(size) as _;
+        std::ptr::copy_nonoverlapping(
+            fds.as_ptr(),
+            libc::CMSG_DATA(header).cast::<RawFd>(),
+            fds.len(),
+        );
+
+        libc::sendmsg(stream.as_raw_fd(), &message, 0)
+    };
+
+    match sent {
+        -1 => Err(io::Error::last_os_error()),
+        _ => Ok(()),
+    }
+}
+
+/// Receive the descriptors sent with `SCM_RIGHTS` on the `stream`.
+///
+/// # Returns
+///
+/// Returns the received descriptors, marked close-on-exec, or the error of the
+/// system.
+#[doc(hidden)]
+fn receive_fds(stream: &UnixStream) -> io::Result<Vec<OwnedFd>> {
+    let size = (std::mem::size_of::<RawFd>() * Handoff::MAX_SOCKETS) as u32;
+    // SAFETY: The macro only computes a size.
+    let mut control = vec![0_u64; (unsafe { libc::CMSG_SPACE(size) } as usize).div_ceil(8)];
+
+    let mut byte = [0_u8];
+    let mut iov = libc::iovec {
+        iov_base: byte.as_mut_ptr().cast(),
+        iov_len: byte.len(),
+    };
+
+    // SAFETY: A message header is plain data, valid when zeroed.
+    let mut message: libc::msghdr = unsafe { std::mem::zeroed() };
+    message.msg_iov = &mut iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control.as_mut_ptr().cast();
+    message.msg_controllen = (control.len() * 8) as _;
+
+    // SAFETY: The buffers live during the call, and their lengths are given.
+    let received = unsafe { libc::recvmsg(stream.as_raw_fd(), &mut message, 0) };
+    match received {
+        -1 => return Err(io::Error::last_os_error()),
+        0 => return Err(ErrorKind::UnexpectedEof.into()),
+        _ => {}
+    }
+
+    let mut fds = Vec::new();
+    // SAFETY: The headers are read in the received part of the control buffer,
+    // and the descriptors are owned by this process after the reception.
+    unsafe {
+        let mut header = libc::CMSG_FIRSTHDR(&message);
+
+        while !header.is_null() {
+            if (*header).cmsg_level == libc::SOL_SOCKET && (*header).cmsg_type == libc::SCM_RIGHTS {
+                let data = libc::CMSG_DATA(header).cast::<RawFd>();
+                let length = (*header).cmsg_len as usize - libc::CMSG_LEN(0) as usize;
+
+                for index in 0..length / std::mem::size_of::<RawFd>() {
+                    let fd = OwnedFd::from_raw_fd(data.add(index).read_unaligned());
+                    libc::fcntl(fd.as_raw_fd(), libc::F_SETFD, libc::FD_CLOEXEC);
+                    fds.push(fd);
+                }
+            }
+
+            header = libc::CMSG_NXTHDR(&message, header);
+        }
+    }
+
+    if message.msg_flags & libc::MSG_CTRUNC != 0 {
+        return Err(io::Error::new(
+            ErrorKind::InvalidData,
+            "Too many sockets received",
+        ));
+    }
+
+    Ok(fds)
+}
@@ -0,0 +1,145 @@
+use std::fmt::{Display, Formatter};
+use std::io;
+use std::net::{SocketAddr, TcpListener};
+use std::os::fd::{AsFd, AsRawFd, BorrowedFd, OwnedFd, RawFd};
+use std::os::unix::net::UnixListener;
+use std::path::PathBuf;
+
+use super::Stream;
+
+/// The listening socket of the server: a TCP socket or a Unix domain socket.
+///
+/// # How to use it?
+///
+/// ```rust
+/// use std::net::TcpListener;
+///
+/// use crate::sockets::Listener;
+///
+/// let listener = Listener::from(TcpListener::bind("127.0.0.1:8000").unwrap());
+///
+/// let stream = listener.accept().unwrap();
+/// ```
+#[derive(Debug)]
+pub enum Listener {
+    /// A TCP socket.
+    Tcp(TcpListener),
+
+    /// A Unix domain socket.
+    Unix(UnixListener),
+}
+
+impl Listener {
+    /// Accept a connection.
+    ///
+    /// # Returns
+    ///
+    /// Returns the stream of the connection, or the error of the system.
+    pub fn accept(&self) -> io::Result<Stream> {
+        match self {
+            Listener::Tcp(listener) => listener.accept().map(|(stream, _)| Stream::Tcp(stream)),
+            Listener::Unix(listener) => listener.accept().map(|(stream, _)| Stream::Unix(stream)),
+        }
+    }
+
+    /// Move the socket into or out of the non-blocking mode.
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the system, or nothing if all is good.
+    pub fn set_nonblocking(&self, nonblocking: bool) -> io::Result<()> {
+        match self {
+            Listener::Tcp(listener) => listener.set_nonblocking(nonblocking),
+            Listener::Unix(listener) => listener.set_nonblocking(nonblocking),
+        }
+    }
+
+    /// Get the local address of the socket.
+    ///
+    /// # Returns
+    ///
+    /// Returns the [`Address`], or the error of the system.
+    pub fn local_addr(&self) -> io::Result<Address> {
+        match self {
+            Listener::Tcp(listener) => listener.local_addr().map(Address::Tcp),
+            Listener::Unix(listener) => Ok(Address::Unix(
+                listener
+                    .local_addr()?
+                    .as_pathname()
+                    .map(PathBuf::from)
+                    .unwrap_or_default(),
+            )),
+        }
+    }
+}
+
+impl AsFd for Listener {
+    fn as_fd(&self) -> BorrowedFd<'_> {
+        match self {
+            Listener::Tcp(listener) => listener.as_fd(),
+            Listener::Unix(listener) => listener.as_fd(),
+        }
+    }
+}
+
+impl AsRawFd for Listener {
+    fn as_raw_fd(&self) -> RawFd {
+        self.as_fd().as_raw_fd()
+    }
+}
+
+impl From<TcpListener> for Listener {
+    fn from(value: TcpListener) -> Listener {
+        Listener::Tcp(value)
+    }
+}
+
+impl From<UnixListener> for Listener {
+    fn from(value: UnixListener) -> Listener {
+        Listener::Unix(value)
+    }
+}
+
+impl From<OwnedFd> for Listener {
+    /// Take the listening `socket`, inherited or received from another process,
+    /// with the kind of its address family.
+    fn from(value: OwnedFd) -> Listener {
+        // SAFETY: An address storage is plain data, valid when zeroed.
+        let mut address: libc::sockaddr_storage = unsafe { std::mem::zeroed() };
+        let mut length = std::mem::size_of::<libc::sockaddr_storage>() as libc::socklen_t;
+
+        // SAFETY: The storage and its length live during the call, and the
+        // length is the size of the storage.
+        let result = unsafe {
+            libc::getsockname(
+                value.as_raw_fd(),
+                (&mut address as *mut libc::sockaddr_storage).cast(),
+                &mut length,
+            )
+        };
+
+        match result == 0 && i32::from(address.ss_family) == libc::AF_UNIX {
+            true => Listener::Unix(UnixListener::from(value)),
+            false => Listener::Tcp(TcpListener::from(value)),
+        }
+    }
+}
+
+/// The address of a [`Listener`].
+#[derive(Debug, Clone, PartialEq, Eq, Hash)]
+pub enum Address {
+    /// The address of a TCP socket.
+    Tcp(SocketAddr),
+
+    /// The path of a Unix domain socket, empty if the socket is unnamed.
+    Unix(PathBuf),
+}
+
+impl Display for Address {
+    fn fmt(&self, f: &mut Formatter<'_>) -> std::fmt::Result {
+        match self {
+            Address::Tcp(address) => write!(f, "{address}"),
+            Address::Unix(path) => write!(f, "unix:{}", path.display()),
+        }
+    }
+}
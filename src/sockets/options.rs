@@ -0,0 +1,144 @@
+use std::fs;
+use std::io;
+use std::os::fd::{AsRawFd, FromRawFd, OwnedFd};
+use std::os::unix::ffi::OsStrExt;
+use std::os::unix::fs::PermissionsExt;
+use std::os::unix::net::{UnixListener, UnixStream};
+use std::path::Path;
+
+/// Set the integer option `name` of the `level` of the `socket`.
+///
+/// # Returns
+///
+/// Returns the error of the system call, or nothing if all is good.
+pub fn set(
+    socket: &impl AsRawFd,
+    level: libc::c_int,
+    name: libc::c_int,
+    value: libc::c_int,
+) -> io::Result<()> {
+    // SAFETY: The file descriptor is owned by the socket, and the option value
+    // is a valid `c_int` living during the call.
+    let result = unsafe {
+        libc::setsockopt(
+            socket.as_raw_fd(),
+            level,
+            name,
+            (&value as *const libc::c_int).cast(),
+            std::mem::size_of::<libc::c_int>() as libc::socklen_t,
+        )
+    };
+
+    match result {
+        0 => Ok(()),
+        _ => Err(io::Error::last_os_error()),
+    }
+}
+
+/// Listen again on the bound `socket`, to change the length of its `backlog`.
+///
+/// # Returns
+///
+/// Returns the error of the system call, or nothing if all is good.
+pub fn listen(socket: &impl AsRawFd, backlog: libc::c_int) -> io::Result<()> {
+    // SAFETY: The file descriptor is owned by the socket.
+    match unsafe { libc::listen(socket.as_raw_fd(), backlog) } {
+        0 => Ok(()),
+        _ => Err(io::Error::last_os_error()),
+    }
+}
+
+/// Bind a Unix domain socket at `path`, and give the `mode` to its file before
+/// listening, so no client connects before the permissions are restricted.
+///
+/// # Returns
+///
+/// Returns the listener, or the error of the system. A `path` too long for a
+/// socket address, or containing a nul byte, is an [`io::ErrorKind::InvalidInput`].
+pub fn bind_unix(path: &Path, mode: u32, backlog: libc::c_int) -> io::Result<UnixListener> {
+    // SAFETY: The address is a plain structure, valid when zeroed.
+    let mut address: libc::sockaddr_un = unsafe { std::mem::zeroed() };
+    address.sun_family = libc::AF_UNIX as libc::sa_family_t;
+
+    let bytes = path.as_os_str().as_bytes();
+    if bytes.len() >= address.sun_path.len() || bytes.contains(&0) {
+        return Err(io::Error::new(
+            io::ErrorKind::InvalidInput,
+            "Invalid path of a Unix domain socket",
+        ));
+    }
+    for (target, byte) in address.sun_path.iter_mut().zip(bytes) {
+        *target = *byte as libc::c_char;
+    }
+
+    // SAFETY: The call creates a new descriptor, owned just after.
+    let fd = unsafe { libc::socket(libc::AF_UNIX, libc::SOCK_STREAM, 0) };
+    if fd == -1 {
+        return Err(io::Error::last_os_error());
+    }
+    // SAFETY: The descriptor is valid and owned by nobody else.
+    let socket = unsafe { OwnedFd::from_raw_fd(fd) };
+
+    // SAFETY: The descriptor is valid during the calls, the address lives
+    // during the call and its length is given.
+    unsafe {
+        if libc::fcntl(socket.as_raw_fd(), libc::F_SETFD, libc::FD_CLOEXEC) == -1 {
+            return Err(io::Error::last_os_error());
+        }
+
+        let length = std::mem::size_of::<libc::sockaddr_un>() as libc::socklen_t;
+        let address = (&address as *const libc::sockaddr_un).cast();
+        if libc::bind(socket.as_raw_fd(), address, length) == -1 {
+            return Err(io::Error::last_os_error());
+        }
+    }
+
+    fs::set_permissions(path, fs::Permissions::from_mode(mode))?;
+    listen(&socket, backlog)?;
+
+    Ok(UnixListener::from(socket))
+}
+
+/// Get the effective user ID of the peer of the `stream`.
+///
+/// # Returns
+///
+/// Returns the user ID, or the error of the system.
+pub fn peer_uid(stream: &UnixStream) -> io::Result<libc::uid_t> {
+    #[cfg(target_os = "linux")]
+    {
+        // SAFETY: The credentials are a plain structure, valid when zeroed.
+        let mut credentials: libc::ucred = unsafe { std::mem::zeroed() };
+        let mut length = std::mem::size_of::<libc::ucred>() as libc::socklen_t;
+
+        // SAFETY: The descriptor is owned by the stream, the credentials and
+        // their length live during the call.
+        let result = unsafe {
+            libc::getsockopt(
+                stream.as_raw_fd(),
+                libc::SOL_SOCKET,
+                libc::SO_PEERCRED,
+                (&mut credentials as *mut libc::ucred).cast(),
+                &mut length,
+            )
+        };
+
+        match result {
+            0 => Ok(credentials.uid),
+            _ => Err(io::Error::last_os_error()),
+        }
+    }
+
+    #[cfg(not(target_os = "linux"))]
+    {
+        let mut uid = 0;
+        let mut gid = 0;
+
+        // SAFETY: The descriptor is owned by the stream, the IDs live during
+        // the call.
+        match unsafe { libc::getpeereid(stream.as_raw_fd(), &mut uid, &mut gid) } {
+            0 => Ok(uid),
+            _ => Err(io::Error::last_os_error()),
+        }
+    }
+}
@@ -0,0 +1,193 @@
+use std::io::{self, Read, Write};
+use std::net::TcpStream;
+use std::os::fd::{AsFd, AsRawFd, BorrowedFd, RawFd};
+use std::os::unix::net::UnixStream;
+use std::time::Duration;
+
+/// The stream of a connection, accepted by a TCP socket or by a Unix domain
+/// socket.
+///
+/// Both are read and written the same way, so the reactor, the parser and the
+/// responses do not depend on the kind of the listener.
+///
+/// # How to use it?
+///
+/// ```rust
+/// use std::io::Write;
+/// use std::net::TcpStream;
+///
+/// use crate::sockets::Stream;
+///
+/// let mut stream = Stream::from(TcpStream::connect("127.0.0.1:8000").unwrap());
+/// stream.write_all(b"GET / HTTP/1.1\r\n\r\n").unwrap();
+/// ```
+#[derive(Debug)]
+pub enum Stream {
+    /// A TCP connection.
+    Tcp(TcpStream),
+
+    /// A connection on a Unix domain socket.
+    Unix(UnixStream),
+}
+
+impl Stream {
+    /// Create a new handle to the same connection.
+    ///
+    /// # Returns
+    ///
+    /// Returns the new handle, or the error of the system.
+    pub fn try_clone(&self) -> io::Result<Stream> {
+        match self {
+            Stream::Tcp(stream) => stream.try_clone().map(Stream::Tcp),
+            Stream::Unix(stream) => stream.try_clone().map(Stream::Unix),
+        }
+    }
+
+    /// Move the stream into or out of the non-blocking mode.
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the system, or nothing if all is good.
+    pub fn set_nonblocking(&self, nonblocking: bool) -> io::Result<()> {
+        match self {
+            Stream::Tcp(stream) => stream.set_nonblocking(nonblocking),
+            Stream::Unix(stream) => stream.set_nonblocking(nonblocking),
+        }
+    }
+
+    /// Disable the coalescing of the small writes of a TCP connection.
+    ///
+    /// A Unix domain socket does not coalesce them, so nothing is done.
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the system, or nothing if all is good.
+    pub fn set_nodelay(&self, nodelay: bool) -> io::Result<()> {
+        match self {
+            Stream::Tcp(stream) => stream.set_nodelay(nodelay),
+            Stream::Unix(_) => Ok(()),
+        }
+    }
+
+    /// Set the maximal duration of a blocking read.
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the system, or nothing if all is good.
+    pub fn set_read_timeout(&self, timeout: Option<Duration>) -> io::Result<()> {
+        match self {
+            Stream::Tcp(stream) => stream.set_read_timeout(timeout),
+            Stream::Unix(stream) => stream.set_read_timeout(timeout),
+        }
+    }
+
+    /// Set the maximal duration of a blocking write.
+    ///
+    /// # Returns
+    ///
+    /// Returns the error of the system, or nothing if all is good.
+    pub fn set_write_timeout(&self, timeout: Option<Duration>) -> io::Result<()> {
+        match self {
+            Stream::Tcp(stream) => stream.set_write_timeout(timeout),
+            Stream::Unix(stream) => stream.set_write_timeout(timeout),
+        }
+    }
+
+    /// Indicate if the peer reset the connection, without consuming the pending
+    /// bytes.
+    ///
+    /// A peer which only closed its side of the connection, like with
+    /// `shutdown(SHUT_WR)`, still waits the response, so it is not reset.
+    ///
+    /// # Returns
+    ///
+    /// Returns `true` if a peek fails with `ECONNRESET` or `EPIPE`.
+    pub fn is_reset(&self) -> bool {
+        let mut byte = 0u8;
+
+        // SAFETY: The descriptor is valid while `self` lives, and the buffer of
+        // one byte lives during the call.
+        let peeked = unsafe {
+            libc::recv(
+                self.as_raw_fd(),
+                (&mut byte as *mut u8).cast(),
+                1,
+                libc::MSG_PEEK | libc::MSG_DONTWAIT,
+            )
+        };
+
+        peeked == -1
+            && matches!(
+                io::Error::last_os_error().raw_os_error(),
+                Some(libc::ECONNRESET | libc::EPIPE),
+            )
+    }
+}
+
+impl Read for Stream {
+    fn read(&mut self, buf: &mut [u8]) -> io::Result<usize> {
+        (&*self).read(buf)
+    }
+}
+
+impl Read for &Stream {
+    fn read(&mut self, buf: &mut [u8]) -> io::Result<usize> {
+        match self {
+            Stream::Tcp(stream) => (&*stream).read(buf),
+            Stream::Unix(stream) => (&*stream).read(buf),
+        }
+    }
+}
+
+impl Write for Stream {
+    fn write(&mut self, buf: &[u8]) -> io::Result<usize> {
+        (&*self).write(buf)
+    }
+
+    fn flush(&mut self) -> io::Result<()> {
+        (&*self).flush()
+    }
+}
+
+impl Write for &Stream {
+    fn write(&mut self, buf: &[u8]) -> io::Result<usize> {
+        match self {
+            Stream::Tcp(stream) => (&*stream).write(buf),
+            Stream::Unix(stream) => (&*stream).write(buf),
+        }
+    }
+
+    fn flush(&mut self) -> io::Result<()> {
+        match self {
+            Stream::Tcp(stream) => (&*stream).flush(),
+            Stream::Unix(stream) => (&*stream).flush(),
+        }
+    }
+}
+
+impl AsFd for Stream {
+    fn as_fd(&self) -> BorrowedFd<'_> {
+        match self {
+            Stream::Tcp(stream) => stream.as_fd(),
+            Stream::Unix(stream) => stream.as_fd(),
+        }
+    }
+}
+
+impl AsRawFd for Stream {
+    fn as_raw_fd(&self) -> RawFd {
+        self.as_fd().as_raw_fd()
+    }
+}
+
+impl From<TcpStream> for Stream {
+    fn from(value: TcpStream) -> Stream {
+        Stream::Tcp(value)
+    }
+}
+
+impl From<UnixStream> for Stream {
+    fn from(value: UnixStream) -> Stream {
+        Stream::Unix(value)
+    }
+}
@@ -2,12 +2,40 @@
 //!
 //! To use [`WorkerPool`], go to the documentation of this class.
 
+pub use self::admission::{Admission, Codel};
+pub use self::affinity::Affinity;
+pub use self::busy_poll::BusyPoll;
 pub use self::pool::WorkerPool;
+pub use self::queue::PushError;
+pub use self::scaling::Scaling;
+pub use self::scheduler::{Placement, Scheduler};
+
+/// Module contains the [`Admission`] control of the jobs.
+mod admission;
+
+/// Module contains the [`Affinity`] of the workers on the CPUs.
+mod affinity;
+
+/// Module contains the [`BusyPoll`] of the idle workers.
+mod busy_poll;
 
 /// Module contains the [`WorkerPool`].
 ///
 /// To use [`WorkerPool`], go to the documentation of this class.
 mod pool;
 
+/// Module contains the [`BoundedQueue`](queue::BoundedQueue) of jobs shared by
+/// the workers.
+mod queue;
+
+/// Module contains the [`Scaling`] of an elastic [`WorkerPool`].
+mod scaling;
+
+/// Module contains the [`Scheduler`] of the [`WorkerPool`].
+mod scheduler;
+
+/// Module contains the local queues of the work-stealing [`Scheduler`].
+mod stealing;
+
 /// Module contains the implementation details about [`Worker`](worker::Worker).
 mod worker;
@@ -0,0 +1,296 @@
+use std::num::NonZeroUsize;
+use std::sync::Mutex;
+use std::time::{Duration, Instant};
+
+use super::pool::WorkerPool;
+
+/// The admission control of the jobs of a [`WorkerPool`][WorkerPool].
+///
+/// A job is rejected when it is pushed, if the queues are full. With [`Codel`],
+/// a popped job is also shed if the jobs wait too long in the queues.
+///
+/// # How to use it?
+///
+/// ```rust
+/// use std::num::NonZeroUsize;
+///
+/// use crate::threads::{Admission, Codel, Scaling, WorkerPool};
+///
+/// let admission = Admission::bounded(NonZeroUsize::new(256).unwrap())
+///     .with_codel(Codel::default());
+///
+/// let workers = WorkerPool::builder(Scaling::fixed(NonZeroUsize::new(4).unwrap()))
+///     .admission(admission)
+///     .build();
+/// ```
+///
+/// <!-- References -->
+///
+/// [WorkerPool]: super::pool::WorkerPool
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Admission {
+    #[doc(hidden)]
+    capacity: NonZeroUsize,
+    #[doc(hidden)]
+    codel: Option<Codel>,
+}
+
+impl Admission {
+    /// Create the admission of at most `capacity` waiting jobs, without shedding.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Admission`].
+    pub fn bounded(capacity: NonZeroUsize) -> Admission {
+        Self {
+            capacity,
+            codel: None,
+        }
+    }
+
+    /// Shed the popped jobs with [`Codel`].
+    ///
+    /// # Returns
+    ///
+    /// Returns the instance of [`Admission`].
+    pub fn with_codel(self, codel: Codel) -> Admission {
+        Self {
+            codel: Some(codel),
+            ..self
+        }
+    }
+
+    /// Get the maximal amount of waiting jobs.
+    pub fn capacity(&self) -> NonZeroUsize {
+        self.capacity
+    }
+
+    /// Get the shedding of the popped jobs.
+    pub fn codel(&self) -> Option<Codel> {
+        self.codel
+    }
+}
+
+impl Default for Admission {
+    /// Create the admission of at most [`WorkerPool::QUEUE_CAPACITY`] waiting
+    /// jobs, without shedding.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Admission`].
+    fn default() -> Self {
+        Self::bounded(NonZeroUsize::new(WorkerPool::QUEUE_CAPACITY).unwrap())
+    }
+}
+
+/// The shedding of the jobs on their waiting time in the queues, like the
+/// [CoDel](https://www.rfc-editor.org/rfc/rfc8289) queue management.
+///
+/// The amount of waiting jobs is a bad signal of overload, because the jobs have
+/// very different costs. So, the shedding starts when the minimal waiting time
+/// of the popped jobs stays above the target during an interval. Then, the jobs
+/// are shed more and more often, until a job waits less than the target.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Codel {
+    #[doc(hidden)]
+    target: Duration,
+    #[doc(hidden)]
+    interval: Duration,
+}
+
+impl Codel {
+    /// The default acceptable waiting time of a job.
+    pub const DEFAULT_TARGET: Duration = Duration::from_millis(50);
+
+    /// The default duration of a waiting time above the target, before shedding.
+    pub const DEFAULT_INTERVAL: Duration = Duration::from_millis(500);
+
+    /// Create the shedding of the jobs waiting more than `target` during
+    /// `interval`.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Codel`].
+    ///
+    /// # Panics
+    ///
+    /// - If `interval` is zero.
+    pub fn new(target: Duration, interval: Duration) -> Codel {
+        assert!(!interval.is_zero(), "The interval of CoDel is zero");
+
+        Self { target, interval }
+    }
+}
+
+impl Default for Codel {
+    /// Create the shedding with [`Codel::DEFAULT_TARGET`] and
+    /// [`Codel::DEFAULT_INTERVAL`].
+    ///
+    /// The defaults are larger than the ones of the packets, because a job lasts
+    /// from microseconds to seconds.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Codel`].
+    fn default() -> Self {
+        Self::new(Self::DEFAULT_TARGET, Self::DEFAULT_INTERVAL)
+    }
+}
+
+/// The state of [`Codel`], shared by the workers of a pool.
+#[derive(Debug)]
+pub struct Shedder {
+    #[doc(hidden)]
+    codel: Codel,
+    #[doc(hidden)]
+    state: Mutex<ShedderState>,
+}
+
+/// The state machine of [RFC 8289](https://www.rfc-editor.org/rfc/rfc8289#section-5).
+#[derive(Debug, Default)]
+#[doc(hidden)]
+struct ShedderState {
+    #[doc(hidden)]
+    first_above: Option<Instant>,
+    #[doc(hidden)]
+    dropping: bool,
+    #[doc(hidden)]
+    drop_next: Option<Instant>,
+    #[doc(hidden)]
+    count: u32,
+}
+
+impl Shedder {
+    /// Create the state of the `codel`.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Shedder`].
+    pub fn new(codel: Codel) -> Shedder {
+        Self {
+            codel,
+            state: Mutex::new(ShedderState::default()),
+        }
+    }
+
+    /// Indicate if the popped job, that waited `waiting_time`, must be shed.
+    ///
+    /// If another worker updates the state, the job is not shed, so the workers
+    /// never wait each other.
+    ///
+    /// # Returns
+    ///
+    /// Returns `true` if the job must be rejected without executing it.
+    pub fn should_shed(&self, waiting_time: Duration) -> bool {
+        let Ok(mut state) = self.state.try_lock() else {
+            return false;
+        };
+
+        let now = Instant::now();
+        let above = self.is_above(&mut state, waiting_time, now);
+
+        if state.dropping {
+            if !above {
+                state.dropping = false;
+                return false;
+            }
+
+            let drop_next = state.drop_next.unwrap_or(now);
+            if now < drop_next {
+                return false;
+            }
+
+            state.count = state.count.saturating_add(1);
+            state.drop_next = Some(self.control_law(drop_next, state.count));
+            true
+        } else if above {
+            // Restart near the previous rate, if the last shedding is recent.
+            let recent = state.drop_next.is_some_and(|drop_next| {
+                now.saturating_duration_since(drop_next) < self.codel.interval * 16
+            });
+
+            state.dropping = true;
+            state.count = if recent && state.count > 2 {
+                state.count - 2
+            } else {
+                1
+            };
+            state.drop_next = Some(self.control_law(now, state.count));
+            true
+        } else {
+            false
+        }
+    }
+
+    /// Indicate if the waiting times stay above the target since one interval.
+    #[doc(hidden)]
+    fn is_above(&self, state: &mut ShedderState, waiting_time: Duration, now: Instant) -> bool {
+        if waiting_time < self.codel.target {
+            state.first_above = None;
+            return false;
+        }
+
+        match state.first_above {
+            None => {
+                state.first_above = Some(now + self.codel.interval);
+                false
+            }
+            Some(first_above) => now >= first_above,
+        }
+    }
+
+    /// Get the instant of the next shedding, after `count` sheddings.
+    #[doc(hidden)]
+    fn control_law(&self, instant: Instant, count: u32) -> Instant {
+        instant + self.codel.interval.div_f64(f64::from(count).sqrt())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use std::thread::sleep;
+    use std::time::Duration;
+
+    use super::{Codel, Shedder};
+
+    /// The target of the tests, far above the waiting times below it.
+    const TARGET: Duration = Duration::from_millis(10);
+
+    /// The interval of the tests.
+    const INTERVAL: Duration = Duration::from_millis(20);
+
+    #[test]
+    fn keep_the_jobs_below_the_target() {
+        let shedder = Shedder::new(Codel::new(TARGET, INTERVAL));
+
+        for _ in 0..3 {
+            assert!(!shedder.should_shed(Duration::from_millis(1)));
+            sleep(INTERVAL);
+        }
+    }
+
+    #[test]
+    fn shed_after_one_interval_above_the_target() {
+        let shedder = Shedder::new(Codel::new(TARGET, INTERVAL));
+        let slow = TARGET * 2;
+
+        // The first slow job starts the interval.
+        assert!(!shedder.should_shed(slow));
+        assert!(!shedder.should_shed(slow));
+
+        sleep(INTERVAL + Duration::from_millis(5));
+        assert!(shedder.should_shed(slow));
+        // The next shedding waits the control law.
+        assert!(!shedder.should_shed(slow));
+
+        // A fast job stops the shedding.
+        assert!(!shedder.should_shed(Duration::ZERO));
+        assert!(!shedder.should_shed(slow));
+    }
+
+    #[test]
+    #[should_panic(expected = "The interval of CoDel is zero")]
+    fn reject_a_zero_interval() {
+        Codel::new(TARGET, Duration::ZERO);
+    }
+}
@@ -0,0 +1,170 @@
+use std::fs::read_dir;
+use std::io;
+use std::num::NonZeroUsize;
+use std::thread::available_parallelism;
+
+/// The placement of the workers of a [`WorkerPool`][WorkerPool] on the CPUs.
+///
+/// # How to use it?
+///
+/// ```rust
+/// use crate::threads::{Affinity, Scaling, WorkerPool};
+///
+/// // Each worker is pinned to one CPU, the CPUs of one NUMA node first.
+/// let workers = WorkerPool::builder(Scaling::fixed(Affinity::available_parallelism()))
+///     .affinity(Affinity::Pinned)
+///     .build();
+/// ```
+///
+/// <!-- References -->
+///
+/// [WorkerPool]: super::pool::WorkerPool
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum Affinity {
+    /// The workers are moved between the CPUs by the system.
+    #[default]
+    Floating,
+
+    /// Each worker is pinned to one CPU. The workers keep warm caches, and the
+    /// memory they allocate comes from their NUMA node.
+    ///
+    /// The CPUs are given in the order of their NUMA nodes, so the neighbours of a
+    /// worker, which it steals first with [`Scheduler::WorkStealing`][Scheduler],
+    /// are on its node.
+    ///
+    /// <!-- References -->
+    ///
+    /// [Scheduler]: super::scheduler::Scheduler
+    Pinned,
+}
+
+impl Affinity {
+    /// Get the amount of CPUs usable by the process.
+    ///
+    /// # Returns
+    ///
+    /// Returns [`available_parallelism()`], or 1 if it is unknown.
+    pub fn available_parallelism() -> NonZeroUsize {
+        available_parallelism().unwrap_or(NonZeroUsize::new(1).unwrap())
+    }
+}
+
+/// The CPUs usable by the process, ordered by NUMA node.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct Topology {
+    #[doc(hidden)]
+    cpus: Box<[usize]>,
+}
+
+impl Topology {
+    /// Detect the CPUs of the process, and their NUMA nodes.
+    ///
+    /// If the nodes are unknown, all CPUs are considered on the same node.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Topology`], or [`None`] if the CPUs cannot be
+    /// detected, like on other systems than Linux.
+    pub fn detect() -> Option<Topology> {
+        let mut cpus: Vec<(usize, usize)> = Self::allowed_cpus()?
+            .into_iter()
+            .map(|cpu| (Self::node_of(cpu).unwrap_or(0), cpu))
+            .collect();
+
+        cpus.sort_unstable();
+
+        (!cpus.is_empty()).then(|| Self {
+            cpus: cpus.into_iter().map(|(_, cpu)| cpu).collect(),
+        })
+    }
+
+    /// Get the CPU of the `worker`.
+    ///
+    /// # Returns
+    ///
+    /// Returns the CPU, the workers share the CPUs if there are more workers than
+    /// CPUs.
+    pub fn cpu_of(&self, worker: usize) -> usize {
+        self.cpus[worker % self.cpus.len()]
+    }
+
+    /// Get the CPUs allowed for the process.
+    #[cfg(target_os = "linux")]
+    #[doc(hidden)]
+    fn allowed_cpus() -> Option<Vec<usize>> {
+        // SAFETY: The set is a plain bit array, valid when zeroed, and its size is
+        // given to the system call.
+        let set = unsafe {
+            let mut set: libc::cpu_set_t = std::mem::zeroed();
+
+            if libc::sched_getaffinity(0, std::mem::size_of::<libc::cpu_set_t>(), &mut set) != 0 {
+                return None;
+            }
+
+            set
+        };
+
+        Some(
+            (0..libc::CPU_SETSIZE as usize)
+                // SAFETY: The CPU is lower than the size of the set.
+                .filter(|cpu| unsafe { libc::CPU_ISSET(*cpu, &set) })
+                .collect(),
+        )
+    }
+
+    #[cfg(not(target_os = "linux"))]
+    #[doc(hidden)]
+    fn allowed_cpus() -> Option<Vec<usize>> {
+        None
+    }
+
+    /// Get the NUMA node of the `cpu`, from the directory
+    /// `/sys/devices/system/cpu/cpu{cpu}/` which contains a link `node{node}`.
+    #[doc(hidden)]
+    fn node_of(cpu: usize) -> Option<usize> {
+        read_dir(format!("/sys/devices/system/cpu/cpu{cpu}"))
+            .ok()?
+            .filter_map(Result::ok)
+            .find_map(|entry| {
+                entry
+                    .file_name()
+                    .to_str()?
+                    .strip_prefix("node")?
+                    .parse()
+                    .ok()
+            })
+    }
+}
+
+/// Pin the current thread to the `cpu`.
+///
+/// # Returns
+///
+/// Returns the error of the system call, or nothing if all is good. On other
+/// systems than Linux, the thread is not pinned.
+#[cfg(target_os = "linux")]
+pub fn pin_current_thread(cpu: usize) -> io::Result<()> {
+    // SAFETY: The set is a plain bit array, valid when zeroed, the CPU is checked
+    // against the size of the set, and its size is given to the system call.
+    let result = unsafe {
+        let mut set: libc::cpu_set_t = std::mem::zeroed();
+
+        if cpu >= libc::CPU_SETSIZE as usize {
+            return Err(io::ErrorKind::InvalidInput.into());
+        }
+        libc::CPU_SET(cpu, &mut set);
+
+        libc::sched_setaffinity(0, std::mem::size_of::<libc::cpu_set_t>(), &set)
+    };
+
+    if result == 0 {
+        Ok(())
+    } else {
+        Err(io::Error::last_os_error())
+    }
+}
+
+#[cfg(not(target_os = "linux"))]
+pub fn pin_current_thread(_cpu: usize) -> io::Result<()> {
+    Ok(())
+}
@@ -0,0 +1,180 @@
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::time::{Duration, Instant};
+
+/// The busy polling of the idle workers of a [`WorkerPool`][WorkerPool].
+///
+/// An idle worker is parked on a condition variable, and the next job wakes it
+/// up through the lock of the queue: a few microseconds on the latency of the
+/// job. With [`BusyPoll::Adaptive`], an idle worker spins on the queues during
+/// its budget before being parked, so a job arriving meanwhile is popped
+/// without any wake-up.
+///
+/// The spin is adaptive: a worker only spins while the jobs arrive densely, that
+/// is when their mean interval is below the budget. Otherwise, the spin would
+/// only burn a CPU, so the worker is parked after the short usual spin.
+///
+/// To also poll the sockets of the connections, cf.[`Endpoint::with_busy_poll()`].
+///
+/// # How to use it?
+///
+/// ```rust
+/// use std::num::NonZeroUsize;
+///
+/// use crate::threads::{Affinity, BusyPoll, Scaling, WorkerPool};
+///
+/// let workers = WorkerPool::builder(Scaling::fixed(NonZeroUsize::new(4).unwrap()))
+///     .affinity(Affinity::Pinned)
+///     .busy_poll(BusyPoll::adaptive())
+///     .build();
+/// ```
+///
+/// <!-- References -->
+///
+/// [WorkerPool]: super::pool::WorkerPool
+/// [`Endpoint::with_busy_poll()`]: crate::sockets::Endpoint::with_busy_poll
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum BusyPoll {
+    /// The idle workers are parked after a short spin.
+    #[default]
+    Off,
+
+    /// The idle workers spin at most the duration before being parked, while the
+    /// jobs arrive densely.
+    Adaptive(Duration),
+}
+
+impl BusyPoll {
+    /// The default budget of the spin of an idle worker.
+    pub const DEFAULT_BUDGET: Duration = Duration::from_micros(50);
+
+    /// Create the adaptive busy polling with the [`BusyPoll::DEFAULT_BUDGET`].
+    ///
+    /// # Returns
+    ///
+    /// Returns [`BusyPoll::Adaptive`].
+    pub fn adaptive() -> BusyPoll {
+        Self::Adaptive(Self::DEFAULT_BUDGET)
+    }
+}
+
+/// The state of [`BusyPoll::Adaptive`], shared by the workers of a pool.
+#[derive(Debug)]
+pub struct Spinner {
+    #[doc(hidden)]
+    budget: Duration,
+    #[doc(hidden)]
+    origin: Instant,
+    /// The instant of the last arrival, in nanoseconds since the origin, or
+    /// [`Spinner::UNKNOWN`] before the first arrival.
+    #[doc(hidden)]
+    last_arrival: AtomicU64,
+    /// The moving average of the interval between two arrivals, in nanoseconds,
+    /// or [`Spinner::UNKNOWN`] before the first interval.
+    #[doc(hidden)]
+    mean_interval: AtomicU64,
+}
+
+impl Spinner {
+    /// The weight of the last interval in the moving average, as a power of two:
+    /// `1/8`.
+    #[doc(hidden)]
+    const WEIGHT_SHIFT: u32 = 3;
+
+    /// The value of an instant or an interval not observed yet.
+    #[doc(hidden)]
+    const UNKNOWN: u64 = u64::MAX;
+
+    /// Create the state of the spin of at most `budget`.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Spinner`], which does not spin until the first
+    /// interval between two arrivals is observed. The average starts at this
+    /// interval.
+    ///
+    /// # Panics
+    ///
+    /// - If `budget` is zero.
+    pub fn new(budget: Duration) -> Spinner {
+        assert!(!budget.is_zero(), "The budget of the busy polling is zero");
+
+        Self {
+            budget,
+            origin: Instant::now(),
+            last_arrival: AtomicU64::new(Self::UNKNOWN),
+            mean_interval: AtomicU64::new(Self::UNKNOWN),
+        }
+    }
+
+    /// Record the arrival of a job.
+    ///
+    /// The concurrent arrivals can lose an update of the average, which is only
+    /// an approximation.
+    pub fn record_arrival(&self) {
+        let now = u64::try_from(self.origin.elapsed().as_nanos()).unwrap_or(Self::UNKNOWN - 1);
+        let last = self.last_arrival.swap(now, Ordering::Relaxed);
+        if last == Self::UNKNOWN {
+            return;
+        }
+        let interval = now.saturating_sub(last);
+
+        let mean = match self.mean_interval.load(Ordering::Relaxed) {
+            Self::UNKNOWN => interval,
+            mean => mean - (mean >> Self::WEIGHT_SHIFT) + (interval >> Self::WEIGHT_SHIFT),
+        };
+        self.mean_interval.store(mean, Ordering::Relaxed);
+    }
+
+    /// Get the end of the spin of an idle worker.
+    ///
+    /// # Returns
+    ///
+    /// Returns the end of the budget, or [`None`] if the jobs arrive too rarely
+    /// to spin.
+    pub fn spin_deadline(&self) -> Option<Instant> {
+        let mean = match self.mean_interval.load(Ordering::Relaxed) {
+            Self::UNKNOWN => return None,
+            mean => Duration::from_nanos(mean),
+        };
+
+        (mean <= self.budget).then(|| Instant::now() + self.budget)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use std::thread::sleep;
+    use std::time::Duration;
+
+    use super::Spinner;
+
+    #[test]
+    fn wait_the_first_interval() {
+        let spinner = Spinner::new(Duration::from_millis(10));
+        assert_eq!(spinner.spin_deadline(), None);
+
+        spinner.record_arrival();
+        assert_eq!(spinner.spin_deadline(), None);
+    }
+
+    #[test]
+    fn spin_while_the_jobs_arrive_densely() {
+        let spinner = Spinner::new(Duration::from_millis(10));
+        for _ in 0..16 {
+            spinner.record_arrival();
+        }
+
+        assert!(spinner.spin_deadline().is_some());
+    }
+
+    #[test]
+    fn park_when_the_jobs_arrive_rarely() {
+        let spinner = Spinner::new(Duration::from_micros(1));
+        for _ in 0..3 {
+            spinner.record_arrival();
+            sleep(Duration::from_millis(2));
+        }
+
+        assert_eq!(spinner.spin_deadline(), None);
+    }
+}
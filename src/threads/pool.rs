@@ -1,9 +1,18 @@
 use std::num::NonZeroUsize;
+use std::sync::mpsc::{sync_channel, Receiver};
 use std::sync::{Arc, Mutex};
-use std::sync::mpsc::{channel, Sender, SendError};
+use std::thread::{park_timeout, sleep, Builder, JoinHandle};
+use std::time::{Duration, Instant};
 
+use crate::logging::{error, warning};
 use crate::requests::Job;
 
+use super::admission::{Admission, Shedder};
+use super::affinity::{Affinity, Topology};
+use super::busy_poll::{BusyPoll, Spinner};
+use super::queue::PushError;
+use super::scaling::{PoolState, Scaling, ScalingEvent};
+use super::scheduler::{JobQueues, Scheduler};
 use super::worker::Worker;
 
 /// A pool of workers to execute multiple [`Job`]s in parallel.
@@ -21,9 +30,47 @@ use super::worker::Worker;
 /// // Now, the pool waits a job.
 /// ```
 ///
+/// To choose how the jobs are given to the workers, check examples of
+/// [`Scheduler`]. The other options are set by the [`PoolBuilder`].
+///
+/// # How to create an elastic pool?
+///
+/// An elastic pool spawns workers when the jobs wait too long, and retires the
+/// idle workers, cf.[`Scaling`].
+///
+/// ```rust
+/// use std::num::NonZeroUsize;
+///
+/// use crate::threads::{Scaling, Scheduler, WorkerPool};
+///
+/// // Create a pool of 2 to 16 workers.
+/// let mut workers = WorkerPool::builder(Scaling::new(
+///     NonZeroUsize::new(2).unwrap(),
+///     NonZeroUsize::new(16).unwrap(),
+/// ))
+/// .scheduler(Scheduler::Shared)
+/// .build();
+///
+/// for event in workers.scaling_events() {
+///     println!("{event}");
+/// }
+/// ```
+///
 /// # How to stop it?
 ///
-/// To stop the pool, just drop it.
+/// To stop the pool, just drop it: the workers end after the remaining jobs.
+/// To bound the wait, call [`WorkerPool::shutdown()`] before.
+///
+/// ```rust
+/// use std::time::{Duration, Instant};
+///
+/// use crate::threads::WorkerPool;
+///
+/// let mut workers = WorkerPool::default();
+///
+/// // The workers still busy after 5 seconds are detached.
+/// workers.shutdown(Instant::now() + Duration::from_secs(5));
+/// ```
 ///
 /// <!-- References -->
 ///
@@ -31,13 +78,30 @@ use super::worker::Worker;
 #[derive(Debug)]
 pub struct WorkerPool {
     #[doc(hidden)]
-    workers: Vec<Worker>,
+    workers: Arc<Mutex<Vec<Option<Worker>>>>,
     #[doc(hidden)]
-    queue: Option<Sender<Job>>,
+    queues: Arc<JobQueues>,
+    #[doc(hidden)]
+    state: Arc<PoolState>,
+    #[doc(hidden)]
+    events: Receiver<ScalingEvent>,
+    #[doc(hidden)]
+    supervisor: Option<JoinHandle<()>>,
 }
 
 impl WorkerPool {
-    /// Create a new WorkerPool.
+    /// The default maximal amount of jobs waiting for a worker.
+    pub const QUEUE_CAPACITY: usize = 1024;
+
+    /// The maximal amount of [`ScalingEvent`]s waiting to be read.
+    pub const EVENTS_CAPACITY: usize = 64;
+
+    /// The interval between two checks of the ended workers, during the
+    /// shutdown.
+    #[doc(hidden)]
+    const JOIN_INTERVAL: Duration = Duration::from_millis(5);
+
+    /// Create a new WorkerPool, with one queue shared by all workers.
     ///
     /// # Parameters
     ///
@@ -51,58 +115,345 @@ impl WorkerPool {
     ///
     /// - If the size is zero.
     pub fn new(capacity: NonZeroUsize) -> WorkerPool {
-        let (sender, receiver) = channel();
-        let receiver = Arc::new(Mutex::new(receiver));
+        Self::builder(Scaling::fixed(capacity)).build()
+    }
 
-        let mut workers = Vec::with_capacity(capacity.get());
-        for id in 0..capacity.get() {
-            workers.push(Worker::new(id, Arc::clone(&receiver)));
+    /// Start the [`PoolBuilder`] of an elastic WorkerPool.
+    ///
+    /// The pool starts with `scaling.min()` workers, and grows up to
+    /// `scaling.max()` workers when the jobs wait too long. The waiting jobs are
+    /// checked by the thread `Supervisor`, so a burst of slow jobs grows the pool
+    /// without waiting for the next job. The supervisor also respawns the workers
+    /// ended by a panic, so the pool keeps its capacity.
+    ///
+    /// # Parameters
+    ///
+    /// - `scaling`: The bounds and the thresholds of the amount of workers.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`PoolBuilder`], with the default options.
+    pub fn builder(scaling: Scaling) -> PoolBuilder {
+        PoolBuilder {
+            scaling,
+            scheduler: Scheduler::default(),
+            affinity: Affinity::default(),
+            admission: Admission::default(),
+            busy_poll: BusyPoll::default(),
         }
+    }
+
+    /// Create a new WorkerPool, with the options of the `builder`.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`WorkerPool`].
+    #[doc(hidden)]
+    fn build(builder: PoolBuilder) -> WorkerPool {
+        let PoolBuilder {
+            scaling,
+            scheduler,
+            affinity,
+            admission,
+            busy_poll,
+        } = builder;
+
+        // The local queues of the work-stealing scheduler are created for all
+        // possible workers, a spawned worker reuses the queue of its slot.
+        let queues = Arc::new(JobQueues::new(
+            scheduler,
+            scaling.max(),
+            admission.capacity(),
+        ));
+
+        let (sender, events) = sync_channel(Self::EVENTS_CAPACITY);
+        let topology = match affinity {
+            Affinity::Floating => None,
+            Affinity::Pinned => Topology::detect(),
+        };
+        let shedder = admission.codel().map(Shedder::new);
+        let spinner = match busy_poll {
+            BusyPoll::Off => None,
+            BusyPoll::Adaptive(budget) => Some(Spinner::new(budget)),
+        };
+        let state = Arc::new(PoolState::new(scaling, sender, topology, shedder, spinner));
+
+        let mut workers = Vec::with_capacity(scaling.max().get());
+        for id in 0..scaling.max().get() {
+            workers.push(
+                (id < scaling.min().get())
+                    .then(|| Worker::new(id, Arc::clone(&queues), Arc::clone(&state))),
+            );
+        }
+
+        let workers = Arc::new(Mutex::new(workers));
+
+        let supervisor = {
+            let workers = Arc::clone(&workers);
+            let queues = Arc::clone(&queues);
+            let state = Arc::clone(&state);
+
+            Builder::new()
+                .name(String::from("Supervisor"))
+                .spawn(move || {
+                    while !queues.is_closed() {
+                        Self::supervise(&workers, &queues, &state);
+                        park_timeout(state.scan_interval());
+                    }
+                })
+                .unwrap()
+        };
 
         Self {
             workers,
-            queue: Some(sender),
+            queues,
+            state,
+            events,
+            supervisor: Some(supervisor),
         }
     }
 
-    /// Execute a [`Job`] in any worker.
+    /// Get the current amount of workers.
+    pub fn size(&self) -> usize {
+        self.state.size()
+    }
+
+    /// Get the [`ScalingEvent`]s since the last call, without waiting.
+    ///
+    /// If the events are not read, the next events are dropped.
+    ///
+    /// # Returns
+    ///
+    /// Returns an iterator over the pending events.
+    pub fn scaling_events(&self) -> impl Iterator<Item = ScalingEvent> + '_ {
+        self.events.try_iter()
+    }
+
+    /// Execute a [`Job`] in any worker, without waiting if the queues are full.
     ///
     /// # Parameters
     ///
     /// - `job`: The [`Job`] to execute.
-    /// If any worker is available, the job is stored in the
-    /// [`std::sync::mpsc::channel()`] and the `job` waits that a worker is available.
     ///
     /// # Returns
     ///
-    /// Returns a [`SendError`] if the queue cannot accept the [`Job`], else returns
-    /// nothing if all is good.
+    /// Returns [`PushError::Full`] with the `job` if the queues are full, so the
+    /// caller can reject it, [`PushError::Closed`] if the queues are closed, else
+    /// returns nothing if all is good.
+    pub fn try_execute(&mut self, job: Job) -> Result<(), PushError<Job>> {
+        if self.queues.len() == 0 {
+            self.state.record_progress();
+        }
+        self.state.record_arrival();
+
+        self.queues.push(job)
+    }
+
+    /// Close the queues, and join the workers as they end, at most until the
+    /// `deadline`.
+    ///
+    /// The workers execute the remaining jobs, then end. They are waited all
+    /// together, so the shutdown lasts as long as the slowest one. The workers
+    /// still busy at the `deadline` are detached, and end with the process.
+    ///
+    /// # Returns
+    ///
+    /// Returns the amount of detached workers.
     ///
     /// # Panics
     ///
-    /// - If the pool is used during its drop.
-    pub fn execute(&mut self, job: Job) -> Result<(), SendError<Job>> {
-        self.queue.as_ref().unwrap().send(job)
+    /// - If the lock is poisoned.
+    pub fn shutdown(&mut self, deadline: Instant) -> usize {
+        self.stop();
+
+        loop {
+            let mut workers = self.workers.lock().expect("Cannot lock the workers");
+
+            for slot in workers.iter_mut() {
+                if slot.as_ref().is_some_and(Worker::is_finished) {
+                    Self::join(slot.take().unwrap());
+                }
+            }
+
+            let remaining = workers.iter().flatten().count();
+            if remaining == 0 {
+                return 0;
+            }
+            if Instant::now() >= deadline {
+                warning!(workers = remaining; "Workers still busy at the deadline; detaching them.");
+                workers.clear();
+                return remaining;
+            }
+
+            drop(workers);
+            sleep(Self::JOIN_INTERVAL);
+        }
+    }
+
+    /// Close the queues, and join the supervisor so no worker is respawned.
+    #[doc(hidden)]
+    fn stop(&mut self) {
+        self.queues.close();
+
+        if let Some(supervisor) = self.supervisor.take() {
+            supervisor.thread().unpark();
+            supervisor.join().unwrap();
+        }
+    }
+
+    /// Join the ended `worker`, and report its panic.
+    #[doc(hidden)]
+    fn join(worker: Worker) {
+        let name = worker.to_string();
+
+        if worker.join().is_err() {
+            error!(worker = name; "Worker ended with a panic.");
+        }
+    }
+
+    /// Join the ended workers, respawn the ones ended by a panic, and spawn a
+    /// worker if the jobs wait too long.
+    #[doc(hidden)]
+    fn supervise(
+        workers: &Mutex<Vec<Option<Worker>>>,
+        queues: &Arc<JobQueues>,
+        state: &Arc<PoolState>,
+    ) {
+        let mut workers = workers.lock().expect("Cannot lock the workers");
+
+        for (id, slot) in workers.iter_mut().enumerate() {
+            if !slot.as_ref().is_some_and(Worker::is_finished) {
+                continue;
+            }
+
+            // A retired worker has already left the pool, a panicked one has not.
+            if slot.take().unwrap().join().is_err() && !queues.is_closed() {
+                *slot = Some(Worker::new(id, Arc::clone(queues), Arc::clone(state)));
+                state.record_respawn(id);
+            }
+        }
+
+        if state.try_grow(queues.len()).is_none() {
+            return;
+        }
+
+        // A retired worker may still occupy its slot, then the growth is retried
+        // on the next check.
+        match workers.iter().position(Option::is_none) {
+            Some(id) => {
+                workers[id] = Some(Worker::new(id, Arc::clone(queues), Arc::clone(state)));
+            }
+            None => state.cancel_growth(),
+        }
     }
 }
 
 impl Drop for WorkerPool {
     fn drop(&mut self) {
-        drop(self.queue.take());
+        self.stop();
 
-        while !self.workers.is_empty() {
-            self.workers.remove(0).join().unwrap();
+        let mut workers = self.workers.lock().expect("Cannot lock the workers");
+        for worker in workers.drain(..).flatten() {
+            Self::join(worker);
         }
     }
 }
 
 impl Default for WorkerPool {
-    /// Create a new WorkerPool with only one worker.
+    /// Create a new WorkerPool with one worker per usable CPU,
+    /// cf.[`Affinity::available_parallelism()`].
     ///
     /// # Returns
     ///
     /// Returns a new instance of [`WorkerPool`].
     fn default() -> Self {
-        Self::new(NonZeroUsize::new(1).unwrap())
+        Self::new(Affinity::available_parallelism())
+    }
+}
+
+/// The options of a [`WorkerPool`], given by value before its creation.
+///
+/// # How to use it?
+///
+/// ```rust
+/// use std::num::NonZeroUsize;
+///
+/// use crate::threads::{Admission, Affinity, BusyPoll, Codel, Scaling, Scheduler, WorkerPool};
+///
+/// let workers = WorkerPool::builder(Scaling::fixed(NonZeroUsize::new(4).unwrap()))
+///     .scheduler(Scheduler::Shared)
+///     .affinity(Affinity::Pinned)
+///     .admission(Admission::default().with_codel(Codel::default()))
+///     .busy_poll(BusyPoll::adaptive())
+///     .build();
+/// ```
+#[derive(Debug, Clone, Copy)]
+pub struct PoolBuilder {
+    #[doc(hidden)]
+    scaling: Scaling,
+    #[doc(hidden)]
+    scheduler: Scheduler,
+    #[doc(hidden)]
+    affinity: Affinity,
+    #[doc(hidden)]
+    admission: Admission,
+    #[doc(hidden)]
+    busy_poll: BusyPoll,
+}
+
+impl PoolBuilder {
+    /// Set the strategy to give the jobs to the workers, [`Scheduler::Shared`]
+    /// by default.
+    pub fn scheduler(mut self, scheduler: Scheduler) -> PoolBuilder {
+        self.scheduler = scheduler;
+        self
+    }
+
+    /// Set the placement of the workers on the CPUs, [`Affinity::Floating`] by
+    /// default.
+    ///
+    /// If the CPUs of the process cannot be detected, the workers are not pinned.
+    pub fn affinity(mut self, affinity: Affinity) -> PoolBuilder {
+        self.affinity = affinity;
+        self
+    }
+
+    /// Set the admission control of the jobs, [`Admission::default()`] by
+    /// default.
+    ///
+    /// When `admission.capacity()` jobs wait, [`WorkerPool::try_execute()`]
+    /// rejects the next jobs. With [`Codel`][Codel], the workers shed the jobs
+    /// waiting too long, instead of executing them.
+    ///
+    /// <!-- References -->
+    ///
+    /// [Codel]: super::admission::Codel
+    pub fn admission(mut self, admission: Admission) -> PoolBuilder {
+        self.admission = admission;
+        self
+    }
+
+    /// Set the busy polling of the idle workers, [`BusyPoll::Off`] by default.
+    ///
+    /// With [`BusyPoll::Adaptive`], the idle workers spin on the queues before
+    /// being parked while the jobs arrive densely, so a job is popped without
+    /// waking up a worker. Pin the workers with [`Affinity::Pinned`], so the
+    /// spinning workers do not move between the CPUs.
+    pub fn busy_poll(mut self, busy_poll: BusyPoll) -> PoolBuilder {
+        self.busy_poll = busy_poll;
+        self
+    }
+
+    /// Create the [`WorkerPool`] and start its workers.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`WorkerPool`].
+    ///
+    /// # Panics
+    ///
+    /// - If the budget of [`BusyPoll::Adaptive`] is zero.
+    pub fn build(self) -> WorkerPool {
+        WorkerPool::build(self)
     }
 }
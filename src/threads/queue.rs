@@ -0,0 +1,632 @@
+use std::cell::UnsafeCell;
+use std::error::Error;
+use std::fmt::{Debug, Display, Formatter};
+use std::mem::MaybeUninit;
+use std::num::NonZeroUsize;
+use std::ops::Deref;
+use std::sync::atomic::{fence, AtomicBool, AtomicUsize, Ordering};
+use std::sync::{Condvar, Mutex};
+use std::time::{Duration, Instant};
+
+/// A bounded multi-producer multi-consumer queue, without lock.
+///
+/// It is the array-based queue of Dmitry Vyukov: each slot has a sequence number
+/// indicating if it can be written by a producer or read by a consumer. So,
+/// producers and consumers only compete with a compare-and-swap on their own
+/// index, and never on a lock.
+///
+/// The lock and the condition variable are only used to park the consumers when
+/// the queue is empty, after a short spin, or after a longer busy polling. A
+/// push takes the lock only if a consumer is parked and no consumer searches;
+/// a consumer popping a value wakes up the next one while values remain.
+///
+/// # How to use it?
+///
+/// ```rust
+/// use std::num::NonZeroUsize;
+/// use std::sync::Arc;
+/// use std::thread;
+///
+/// use crate::threads::queue::BoundedQueue;
+///
+/// let queue = Arc::new(BoundedQueue::new(NonZeroUsize::new(16).unwrap()));
+///
+/// let consumer = {
+///     let queue = Arc::clone(&queue);
+///     thread::spawn(move || while let Some(value) = queue.pop_wait(None, None) {
+///         println!("{value}");
+///     })
+/// };
+///
+/// queue.push(42).unwrap();
+///
+/// // The consumer ends after the pop of the remaining values.
+/// queue.close();
+/// consumer.join().unwrap();
+/// ```
+pub struct BoundedQueue<T> {
+    #[doc(hidden)]
+    slots: Box<[Slot<T>]>,
+    #[doc(hidden)]
+    mask: usize,
+    #[doc(hidden)]
+    enqueue_position: CachePadded<AtomicUsize>,
+    #[doc(hidden)]
+    dequeue_position: CachePadded<AtomicUsize>,
+    #[doc(hidden)]
+    spins: usize,
+    #[doc(hidden)]
+    closed: AtomicBool,
+    #[doc(hidden)]
+    spinning: AtomicUsize,
+    #[doc(hidden)]
+    parked: AtomicUsize,
+    #[doc(hidden)]
+    lock: Mutex<usize>,
+    #[doc(hidden)]
+    available: Condvar,
+}
+
+// SAFETY: A value is moved into a slot by only one producer, and moved out by
+// only one consumer, the sequence of the slot synchronizes them.
+unsafe impl<T: Send> Send for BoundedQueue<T> {}
+// SAFETY: Same as `Send`, the slots are only accessed through their sequence.
+unsafe impl<T: Send> Sync for BoundedQueue<T> {}
+
+impl<T> BoundedQueue<T> {
+    /// The amount of tries to pop a value before parking the consumer, on a
+    /// multicore system.
+    #[doc(hidden)]
+    const SPINS: usize = 64;
+
+    /// The amount of times the consumer yields its core before being parked, after
+    /// its spin. On a single core, it lets the producer push the next values,
+    /// instead of waking up the consumer for each one.
+    #[doc(hidden)]
+    const YIELDS: usize = 16;
+
+    /// Create a new queue.
+    ///
+    /// # Parameters
+    ///
+    /// - `capacity`: The maximal amount of values in the queue, rounded up to the
+    /// next power of two, and at least 2.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`BoundedQueue`].
+    pub fn new(capacity: NonZeroUsize) -> BoundedQueue<T> {
+        // With one slot, the sequence of a full slot is the one of an empty slot.
+        let capacity = capacity.get().next_power_of_two().max(2);
+
+        Self {
+            slots: (0..capacity)
+                .map(|index| Slot {
+                    sequence: AtomicUsize::new(index),
+                    value: UnsafeCell::new(MaybeUninit::uninit()),
+                })
+                .collect(),
+            mask: capacity - 1,
+            enqueue_position: CachePadded(AtomicUsize::new(0)),
+            dequeue_position: CachePadded(AtomicUsize::new(0)),
+            // Spinning on a single core only delays the producer.
+            spins: match std::thread::available_parallelism() {
+                Ok(cores) if cores.get() > 1 => Self::SPINS,
+                _ => 0,
+            },
+            closed: AtomicBool::new(false),
+            spinning: AtomicUsize::new(0),
+            parked: AtomicUsize::new(0),
+            lock: Mutex::new(0),
+            available: Condvar::new(),
+        }
+    }
+
+    /// Get the maximal amount of values in the queue.
+    pub fn capacity(&self) -> usize {
+        self.slots.len()
+    }
+
+    /// Get the approximate amount of values in the queue.
+    pub fn len(&self) -> usize {
+        let dequeue = self.dequeue_position.load(Ordering::Relaxed);
+        let enqueue = self.enqueue_position.load(Ordering::Relaxed);
+
+        enqueue.wrapping_sub(dequeue).min(self.capacity())
+    }
+
+    /// Indicate if the queue is approximately empty.
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// Push the `value` at the end of the queue, and wake up a parked consumer.
+    ///
+    /// # Returns
+    ///
+    /// Returns nothing if the value is pushed, or [`PushError`] with the `value`
+    /// if the queue is full or closed.
+    pub fn push(&self, value: T) -> Result<(), PushError<T>> {
+        if self.closed.load(Ordering::Acquire) {
+            return Err(PushError::Closed(value));
+        }
+
+        let mut position = self.enqueue_position.load(Ordering::Relaxed);
+        loop {
+            let slot = &self.slots[position & self.mask];
+            let sequence = slot.sequence.load(Ordering::Acquire);
+
+            match (sequence as isize).wrapping_sub(position as isize) {
+                0 => match self.enqueue_position.compare_exchange_weak(
+                    position,
+                    position.wrapping_add(1),
+                    Ordering::Relaxed,
+                    Ordering::Relaxed,
+                ) {
+                    Ok(_) => {
+                        // SAFETY: The successful swap gives the exclusive access to
+                        // the slot, until the store of its new sequence.
+                        unsafe { (*slot.value.get()).write(value) };
+                        slot.sequence
+                            .store(position.wrapping_add(1), Ordering::Release);
+                        break;
+                    }
+                    Err(current) => position = current,
+                },
+                difference if difference < 0 => return Err(PushError::Full(value)),
+                _ => position = self.enqueue_position.load(Ordering::Relaxed),
+            }
+        }
+
+        self.unpark();
+
+        Ok(())
+    }
+
+    /// Pop the first value of the queue, without waiting.
+    ///
+    /// # Returns
+    ///
+    /// Returns the value, or [`None`] if the queue is empty.
+    pub fn pop(&self) -> Option<T> {
+        let mut position = self.dequeue_position.load(Ordering::Relaxed);
+        loop {
+            let slot = &self.slots[position & self.mask];
+            let sequence = slot.sequence.load(Ordering::Acquire);
+
+            match (sequence as isize).wrapping_sub(position.wrapping_add(1) as isize) {
+                0 => match self.dequeue_position.compare_exchange_weak(
+                    position,
+                    position.wrapping_add(1),
+                    Ordering::Relaxed,
+                    Ordering::Relaxed,
+                ) {
+                    Ok(_) => {
+                        // SAFETY: The successful swap gives the exclusive access to
+                        // the slot, and its sequence proves that it was written.
+                        let value = unsafe { (*slot.value.get()).assume_init_read() };
+                        slot.sequence.store(
+                            position.wrapping_add(self.mask).wrapping_add(1),
+                            Ordering::Release,
+                        );
+                        return Some(value);
+                    }
+                    Err(current) => position = current,
+                },
+                difference if difference < 0 => return None,
+                _ => position = self.dequeue_position.load(Ordering::Relaxed),
+            }
+        }
+    }
+
+    /// Pop the first value of the queue, and wait until a value is pushed if the
+    /// queue is empty.
+    ///
+    /// # Parameters
+    ///
+    /// Same as [`BoundedQueue::pop_wait_with()`].
+    ///
+    /// # Returns
+    ///
+    /// Returns the value, or [`None`] if the queue is closed and empty, or if the
+    /// `timeout` elapses.
+    pub fn pop_wait(&self, timeout: Option<Duration>, spin_until: Option<Instant>) -> Option<T> {
+        self.pop_wait_with(|| self.pop(), timeout, spin_until)
+    }
+
+    /// Search a value with `search`, and park the consumer on this queue until
+    /// a value is pushed if nothing is found.
+    ///
+    /// The consumer spins a short time, or until `spin_until` with the busy
+    /// polling, then yields its core a few times before being parked. While a
+    /// consumer spins, the producers do not wake up the parked ones, but the
+    /// consumer finding a value wakes up the next one if values remain.
+    ///
+    /// # Parameters
+    ///
+    /// - `search`: Pop a value from this queue, or from other queues. The consumer
+    /// parked on this queue can be woken up with [`BoundedQueue::unpark()`] when a
+    /// value is pushed into another queue.
+    /// - `timeout`: The maximal duration to wait a value, or [`None`] to wait
+    /// until the queue is closed.
+    /// - `spin_until`: The end of the busy polling before the first park, or
+    /// [`None`] for a short spin. It is ignored on a single core.
+    ///
+    /// # Returns
+    ///
+    /// Returns the value, or [`None`] if the queue is closed and `search` finds
+    /// nothing, or if the `timeout` elapses.
+    pub fn pop_wait_with(
+        &self,
+        mut search: impl FnMut() -> Option<T>,
+        timeout: Option<Duration>,
+        spin_until: Option<Instant>,
+    ) -> Option<T> {
+        let deadline = timeout.map(|timeout| Instant::now() + timeout);
+        let mut woken_up = false;
+
+        loop {
+            // A woken up consumer is already counted by `unpark_one()`.
+            if !woken_up {
+                self.spinning.fetch_add(1, Ordering::Relaxed);
+            }
+
+            loop {
+                for _ in 0..=self.spins {
+                    if let Some(value) = search() {
+                        self.spinning.fetch_sub(1, Ordering::Relaxed);
+                        self.chain_unpark();
+                        return Some(value);
+                    }
+                    std::hint::spin_loop();
+                }
+
+                let busy_polling = self.spins > 0
+                    && spin_until.is_some_and(|spin_until| Instant::now() < spin_until);
+                if !busy_polling || self.closed.load(Ordering::Acquire) {
+                    break;
+                }
+            }
+
+            for _ in 0..Self::YIELDS {
+                std::thread::yield_now();
+                if let Some(value) = search() {
+                    self.spinning.fetch_sub(1, Ordering::Relaxed);
+                    self.chain_unpark();
+                    return Some(value);
+                }
+            }
+            self.spinning.fetch_sub(1, Ordering::Relaxed);
+
+            let mut permits = self.lock.lock().unwrap();
+            self.parked.fetch_add(1, Ordering::Relaxed);
+
+            // Pairs with the fence in `push()`: either the consumer sees the
+            // value, or the producer sees the parked consumer.
+            fence(Ordering::SeqCst);
+
+            let value = search();
+            if value.is_some() || self.closed.load(Ordering::Acquire) {
+                self.parked.fetch_sub(1, Ordering::Relaxed);
+                drop(permits);
+
+                let value = value.or_else(&mut search);
+                if value.is_some() {
+                    self.chain_unpark();
+                }
+                return value;
+            }
+
+            let timed_out = match deadline {
+                None => {
+                    permits = self.available.wait(permits).unwrap();
+                    false
+                }
+                Some(deadline) => {
+                    let remaining = deadline.saturating_duration_since(Instant::now());
+                    let result = self.available.wait_timeout(permits, remaining).unwrap();
+                    permits = result.0;
+                    result.1.timed_out()
+                }
+            };
+
+            woken_up = *permits > 0;
+            if woken_up {
+                *permits -= 1;
+            } else {
+                self.parked.fetch_sub(1, Ordering::Relaxed);
+                if timed_out {
+                    return None;
+                }
+            }
+        }
+    }
+
+    /// Indicate if a consumer of this queue spins, or is woken up, to search a
+    /// value.
+    pub fn is_searched(&self) -> bool {
+        self.spinning.load(Ordering::Relaxed) > 0
+    }
+
+    /// Indicate if a consumer of this queue is idle: it searches a value, or it is
+    /// parked.
+    pub fn has_idle_consumer(&self) -> bool {
+        self.spinning.load(Ordering::Relaxed) > 0 || self.parked.load(Ordering::Relaxed) > 0
+    }
+
+    /// Wake up a consumer parked on this queue, to search a value pushed into
+    /// another queue.
+    ///
+    /// # Returns
+    ///
+    /// Returns `true` if a consumer is woken up, or `false` if no consumer is
+    /// parked, or if a consumer already searches.
+    pub fn unpark(&self) -> bool {
+        // Pairs with the fence in `pop_wait_with()`: either the consumer sees the
+        // value, or the producer sees the parked consumer.
+        fence(Ordering::SeqCst);
+
+        self.spinning.load(Ordering::Relaxed) == 0
+            && self.parked.load(Ordering::Relaxed) > 0
+            && self.unpark_one()
+    }
+
+    /// Wake up the next parked consumer if values remain after a pop.
+    ///
+    /// The producers do not wake up a consumer while another one searches, so a
+    /// burst pushed meanwhile is only seen by the searching consumer. Each
+    /// consumer finding a value wakes up the next one, so the burst is spread on
+    /// all the consumers instead of being popped one by one.
+    #[doc(hidden)]
+    fn chain_unpark(&self) {
+        // A value pushed later wakes up a consumer by itself, cf. `unpark()`.
+        if self.is_empty() {
+            return;
+        }
+
+        // Pairs with the fence in `pop_wait_with()`, like `unpark()`: either the
+        // parking consumer sees the remaining values, or this one sees it parked.
+        fence(Ordering::SeqCst);
+
+        if self.parked.load(Ordering::Relaxed) > 0 && self.spinning.load(Ordering::Relaxed) == 0 {
+            self.unpark_one();
+        }
+    }
+
+    /// Wake up one parked consumer, that is not already woken up.
+    ///
+    /// The woken up consumer is counted as spinning instead of parked, so the next
+    /// pushes do not wake up another consumer before it searches a value.
+    ///
+    /// # Returns
+    ///
+    /// Returns `true` if a consumer is woken up.
+    #[doc(hidden)]
+    fn unpark_one(&self) -> bool {
+        let mut permits = self.lock.lock().unwrap();
+
+        if self.parked.load(Ordering::Relaxed) == 0 {
+            return false;
+        }
+
+        *permits += 1;
+        self.parked.fetch_sub(1, Ordering::Relaxed);
+        self.spinning.fetch_add(1, Ordering::Relaxed);
+        self.available.notify_one();
+
+        true
+    }
+
+    /// Indicate if the queue is closed.
+    pub fn is_closed(&self) -> bool {
+        self.closed.load(Ordering::Acquire)
+    }
+
+    /// Close the queue: next pushes fail, and the consumers end after the pop of
+    /// the remaining values.
+    pub fn close(&self) {
+        self.closed.store(true, Ordering::Release);
+
+        let _guard = self.lock.lock().unwrap();
+        self.available.notify_all();
+    }
+}
+
+impl<T> Drop for BoundedQueue<T> {
+    fn drop(&mut self) {
+        while self.pop().is_some() {}
+    }
+}
+
+impl<T> Debug for BoundedQueue<T> {
+    fn fmt(&self, f: &mut Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("BoundedQueue")
+            .field("capacity", &self.capacity())
+            .field("len", &self.len())
+            .field("closed", &self.closed.load(Ordering::Relaxed))
+            .finish()
+    }
+}
+
+/// Indicate that [`BoundedQueue::push()`] cannot push the value.
+pub enum PushError<T> {
+    /// The queue is full.
+    Full(T),
+    /// The queue is closed.
+    Closed(T),
+}
+
+impl<T> Debug for PushError<T> {
+    fn fmt(&self, f: &mut Formatter<'_>) -> std::fmt::Result {
+        match self {
+            Self::Full(_) => f.write_str("Full(..)"),
+            Self::Closed(_) => f.write_str("Closed(..)"),
+        }
+    }
+}
+
+impl<T> Display for PushError<T> {
+    fn fmt(&self, f: &mut Formatter<'_>) -> std::fmt::Result {
+        let msg = match self {
+            Self::Full(_) => "The queue is full",
+            Self::Closed(_) => "The queue is closed",
+        };
+
+        write!(f, "{}", msg)
+    }
+}
+
+impl<T> Error for PushError<T> {}
+
+/// A slot of the [`BoundedQueue`].
+#[doc(hidden)]
+struct Slot<T> {
+    #[doc(hidden)]
+    sequence: AtomicUsize,
+    #[doc(hidden)]
+    value: UnsafeCell<MaybeUninit<T>>,
+}
+
+/// Align the value on a cache line, to avoid the false sharing between the
+/// producers and the consumers.
+#[doc(hidden)]
+#[repr(align(64))]
+struct CachePadded<T>(T);
+
+impl<T> Deref for CachePadded<T> {
+    type Target = T;
+
+    fn deref(&self) -> &T {
+        &self.0
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use std::num::NonZeroUsize;
+    use std::sync::Arc;
+    use std::thread;
+    use std::time::Duration;
+
+    use super::{BoundedQueue, PushError};
+
+    /// Create a queue of the `capacity`.
+    fn queue<T>(capacity: usize) -> BoundedQueue<T> {
+        BoundedQueue::new(NonZeroUsize::new(capacity).unwrap())
+    }
+
+    #[test]
+    fn round_up_the_capacity() {
+        assert_eq!(queue::<u32>(1).capacity(), 2);
+        assert_eq!(queue::<u32>(5).capacity(), 8);
+        assert_eq!(queue::<u32>(16).capacity(), 16);
+    }
+
+    #[test]
+    fn pop_in_the_order_of_the_pushes() {
+        let queue = queue(4);
+        for value in 0..4 {
+            queue.push(value).unwrap();
+        }
+
+        assert!(matches!(queue.push(4), Err(PushError::Full(4))));
+        assert_eq!(queue.len(), 4);
+
+        for value in 0..4 {
+            assert_eq!(queue.pop(), Some(value));
+        }
+        assert_eq!(queue.pop(), None);
+        assert!(queue.is_empty());
+    }
+
+    #[test]
+    fn reuse_the_slots_after_a_turn() {
+        let queue = queue(2);
+        for value in 0..100 {
+            queue.push(value).unwrap();
+            assert_eq!(queue.pop(), Some(value));
+        }
+    }
+
+    #[test]
+    fn pop_the_remaining_values_after_the_close() {
+        let queue = queue(4);
+        queue.push(1).unwrap();
+        queue.close();
+
+        assert!(matches!(queue.push(2), Err(PushError::Closed(2))));
+        assert_eq!(queue.pop_wait(None, None), Some(1));
+        assert_eq!(queue.pop_wait(None, None), None);
+    }
+
+    #[test]
+    fn stop_waiting_after_the_timeout() {
+        let queue = queue::<u32>(4);
+
+        assert_eq!(queue.pop_wait(Some(Duration::from_millis(10)), None), None);
+    }
+
+    #[test]
+    fn drop_the_remaining_values() {
+        let value = Arc::new(());
+        let queue = queue(4);
+        queue.push(Arc::clone(&value)).unwrap();
+        queue.push(Arc::clone(&value)).unwrap();
+
+        drop(queue);
+        assert_eq!(Arc::strong_count(&value), 1);
+    }
+
+    #[test]
+    fn pop_each_value_once_under_contention() {
+        const PRODUCERS: usize = 4;
+        const CONSUMERS: usize = 4;
+        const VALUES: usize = 20_000;
+
+        let queue = Arc::new(queue(64));
+
+        let consumers: Vec<_> = (0..CONSUMERS)
+            .map(|_| {
+                let queue = Arc::clone(&queue);
+                thread::spawn(move || {
+                    let mut popped = Vec::new();
+                    while let Some(value) = queue.pop_wait(None, None) {
+                        popped.push(value);
+                    }
+                    popped
+                })
+            })
+            .collect();
+
+        let producers: Vec<_> = (0..PRODUCERS)
+            .map(|producer| {
+                let queue = Arc::clone(&queue);
+                thread::spawn(move || {
+                    for value in (producer..VALUES).step_by(PRODUCERS) {
+                        let mut value = value;
+                        while let Err(error) = queue.push(value) {
+                            match error {
+                                PushError::Full(rejected) => value = rejected,
+                                PushError::Closed(_) => panic!("The queue is closed"),
+                            }
+                            thread::yield_now();
+                        }
+                    }
+                })
+            })
+            .collect();
+
+        for producer in producers {
+            producer.join().unwrap();
+        }
+        queue.close();
+
+        let mut popped: Vec<usize> = consumers
+            .into_iter()
+            .flat_map(|consumer| consumer.join().unwrap())
+            .collect();
+        popped.sort_unstable();
+
+        assert_eq!(popped, (0..VALUES).collect::<Vec<_>>());
+    }
+}
@@ -0,0 +1,388 @@
+use std::fmt::{Display, Formatter};
+use std::num::NonZeroUsize;
+use std::sync::atomic::{AtomicU64, AtomicUsize, Ordering};
+use std::sync::mpsc::SyncSender;
+use std::time::{Duration, Instant};
+
+use super::admission::Shedder;
+use super::affinity::Topology;
+use super::busy_poll::Spinner;
+
+/// The bounds and the thresholds of an elastic [`WorkerPool`][WorkerPool].
+///
+/// The pool spawns a worker when a job waits longer than the wait threshold, and
+/// a worker retires when it has no job during the idle cooldown. The amount of
+/// workers stays between the minimum and the maximum.
+///
+/// # How to use it?
+///
+/// ```rust
+/// use std::num::NonZeroUsize;
+/// use std::time::Duration;
+///
+/// use crate::threads::{Scaling, Scheduler, WorkerPool};
+///
+/// let scaling = Scaling::new(NonZeroUsize::new(2).unwrap(), NonZeroUsize::new(16).unwrap())
+///     .with_wait_threshold(Duration::from_millis(20))
+///     .with_idle_cooldown(Duration::from_secs(60));
+///
+/// let workers = WorkerPool::builder(scaling)
+///     .scheduler(Scheduler::Shared)
+///     .build();
+/// ```
+///
+/// <!-- References -->
+///
+/// [WorkerPool]: super::pool::WorkerPool
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Scaling {
+    #[doc(hidden)]
+    min: NonZeroUsize,
+    #[doc(hidden)]
+    max: NonZeroUsize,
+    #[doc(hidden)]
+    wait_threshold: Duration,
+    #[doc(hidden)]
+    idle_cooldown: Duration,
+}
+
+impl Scaling {
+    /// The default waiting time of a job, before spawning a worker.
+    pub const DEFAULT_WAIT_THRESHOLD: Duration = Duration::from_millis(50);
+
+    /// The default idle time of a worker, before retiring it.
+    pub const DEFAULT_IDLE_COOLDOWN: Duration = Duration::from_secs(30);
+
+    /// Create the scaling between `min` and `max` workers, with the default
+    /// thresholds.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Scaling`].
+    ///
+    /// # Panics
+    ///
+    /// - If `min` is greater than `max`.
+    pub fn new(min: NonZeroUsize, max: NonZeroUsize) -> Scaling {
+        assert!(
+            min <= max,
+            "The minimum of workers {} is greater than the maximum {}",
+            min,
+            max,
+        );
+
+        Self {
+            min,
+            max,
+            wait_threshold: Self::DEFAULT_WAIT_THRESHOLD,
+            idle_cooldown: Self::DEFAULT_IDLE_COOLDOWN,
+        }
+    }
+
+    /// Create the scaling of a pool with always `size` workers.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`Scaling`].
+    pub fn fixed(size: NonZeroUsize) -> Scaling {
+        Self::new(size, size)
+    }
+
+    /// Set the waiting time of a job, before spawning a worker.
+    ///
+    /// # Returns
+    ///
+    /// Returns the instance of [`Scaling`].
+    pub fn with_wait_threshold(self, wait_threshold: Duration) -> Scaling {
+        Self {
+            wait_threshold,
+            ..self
+        }
+    }
+
+    /// Set the idle time of a worker, before retiring it.
+    ///
+    /// # Returns
+    ///
+    /// Returns the instance of [`Scaling`].
+    pub fn with_idle_cooldown(self, idle_cooldown: Duration) -> Scaling {
+        Self {
+            idle_cooldown,
+            ..self
+        }
+    }
+
+    /// Get the minimal amount of workers.
+    pub fn min(&self) -> NonZeroUsize {
+        self.min
+    }
+
+    /// Get the maximal amount of workers.
+    pub fn max(&self) -> NonZeroUsize {
+        self.max
+    }
+
+    /// Indicate if the amount of workers never changes.
+    pub fn is_fixed(&self) -> bool {
+        self.min == self.max
+    }
+}
+
+/// A change of the amount of workers of an elastic [`WorkerPool`][WorkerPool].
+///
+/// <!-- References -->
+///
+/// [WorkerPool]: super::pool::WorkerPool
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum ScalingEvent {
+    /// A worker is spawned, because a job waited `waiting_time`.
+    Grown { size: usize, waiting_time: Duration },
+
+    /// An idle worker is retired.
+    Shrunk { size: usize },
+
+    /// The worker `id` ended with a panic, and is replaced.
+    Respawned { id: usize },
+}
+
+impl Display for ScalingEvent {
+    fn fmt(&self, f: &mut Formatter<'_>) -> std::fmt::Result {
+        match self {
+            Self::Grown { size, waiting_time } => write!(
+                f,
+                "Pool grown to {} workers, a job waited {:?}.",
+                size, waiting_time,
+            ),
+            Self::Shrunk { size } => write!(f, "Pool shrunk to {} workers.", size),
+            Self::Respawned { id } => write!(f, "Worker {} respawned after a panic.", id),
+        }
+    }
+}
+
+/// The state of an elastic [`WorkerPool`][WorkerPool], shared with its workers.
+///
+/// <!-- References -->
+///
+/// [WorkerPool]: super::pool::WorkerPool
+#[derive(Debug)]
+pub struct PoolState {
+    #[doc(hidden)]
+    scaling: Scaling,
+    #[doc(hidden)]
+    size: AtomicUsize,
+    #[doc(hidden)]
+    origin: Instant,
+    #[doc(hidden)]
+    last_progress: AtomicU64,
+    #[doc(hidden)]
+    longest_wait: AtomicU64,
+    #[doc(hidden)]
+    events: SyncSender<ScalingEvent>,
+    #[doc(hidden)]
+    topology: Option<Topology>,
+    #[doc(hidden)]
+    shedder: Option<Shedder>,
+    #[doc(hidden)]
+    spinner: Option<Spinner>,
+}
+
+impl PoolState {
+    /// Create the state of a pool with `scaling.min()` workers.
+    ///
+    /// # Parameters
+    ///
+    /// - `scaling`: The bounds and the thresholds of the pool.
+    /// - `events`: The sender of the [`ScalingEvent`]s, the events are dropped if
+    /// the channel is full.
+    /// - `topology`: The CPUs of the pinned workers, or [`None`] if the workers
+    /// are not pinned.
+    /// - `shedder`: The shedding of the jobs waiting too long, or [`None`] to
+    /// execute all popped jobs.
+    /// - `spinner`: The busy polling of the idle workers, or [`None`] to park
+    /// them after a short spin.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`PoolState`].
+    pub fn new(
+        scaling: Scaling,
+        events: SyncSender<ScalingEvent>,
+        topology: Option<Topology>,
+        shedder: Option<Shedder>,
+        spinner: Option<Spinner>,
+    ) -> PoolState {
+        Self {
+            scaling,
+            size: AtomicUsize::new(scaling.min.get()),
+            origin: Instant::now(),
+            last_progress: AtomicU64::new(0),
+            longest_wait: AtomicU64::new(0),
+            events,
+            topology,
+            shedder,
+            spinner,
+        }
+    }
+
+    /// Indicate if the popped job, that waited `waiting_time`, must be shed.
+    ///
+    /// # Returns
+    ///
+    /// Returns `true` if the job must be rejected, always `false` without
+    /// shedding.
+    pub fn should_shed(&self, waiting_time: Duration) -> bool {
+        self.shedder
+            .as_ref()
+            .is_some_and(|shedder| shedder.should_shed(waiting_time))
+    }
+
+    /// Record the arrival of a job, for the busy polling.
+    pub fn record_arrival(&self) {
+        if let Some(spinner) = &self.spinner {
+            spinner.record_arrival();
+        }
+    }
+
+    /// Get the end of the spin of an idle worker.
+    ///
+    /// # Returns
+    ///
+    /// Returns the end of the spin, or [`None`] without busy polling or if the
+    /// jobs arrive too rarely.
+    pub fn spin_deadline(&self) -> Option<Instant> {
+        self.spinner.as_ref().and_then(Spinner::spin_deadline)
+    }
+
+    /// Get the CPU of the `worker`.
+    ///
+    /// # Returns
+    ///
+    /// Returns the CPU, or [`None`] if the workers are not pinned.
+    pub fn cpu_of(&self, worker: usize) -> Option<usize> {
+        self.topology
+            .as_ref()
+            .map(|topology| topology.cpu_of(worker))
+    }
+
+    /// Get the current amount of workers.
+    pub fn size(&self) -> usize {
+        self.size.load(Ordering::Relaxed)
+    }
+
+    /// Get the idle time of a worker before it tries to retire.
+    ///
+    /// # Returns
+    ///
+    /// Returns the idle cooldown, or [`None`] if the pool is fixed.
+    pub fn idle_timeout(&self) -> Option<Duration> {
+        (!self.scaling.is_fixed()).then_some(self.scaling.idle_cooldown)
+    }
+
+    /// Get the interval between two checks of the waiting jobs.
+    pub fn scan_interval(&self) -> Duration {
+        (self.scaling.wait_threshold / 2).max(Duration::from_millis(1))
+    }
+
+    /// Record that the queue makes progress: a job is popped, or a job is pushed
+    /// into an empty queue.
+    pub fn record_progress(&self) {
+        self.last_progress
+            .store(self.elapsed_nanos(), Ordering::Relaxed);
+    }
+
+    /// Record that a worker pops a job, that waited `waiting_time`.
+    pub fn record_pop(&self, waiting_time: Duration) {
+        self.record_progress();
+
+        if waiting_time > self.scaling.wait_threshold {
+            self.longest_wait
+                .fetch_max(Self::nanos(waiting_time), Ordering::Relaxed);
+        }
+    }
+
+    /// Try to spawn a worker, if a job waits longer than the threshold.
+    ///
+    /// A job waits too long if a worker popped it after the threshold, or if the
+    /// `queued` jobs are not popped since the threshold.
+    ///
+    /// # Returns
+    ///
+    /// Returns the waiting time of the job, if the amount of workers is increased.
+    pub fn try_grow(&self, queued: usize) -> Option<Duration> {
+        if self.scaling.is_fixed() {
+            return None;
+        }
+
+        let longest_wait = Duration::from_nanos(self.longest_wait.swap(0, Ordering::Relaxed));
+        let stalled = Duration::from_nanos(
+            self.elapsed_nanos()
+                .saturating_sub(self.last_progress.load(Ordering::Relaxed)),
+        );
+
+        let waiting_time = if longest_wait > self.scaling.wait_threshold {
+            longest_wait
+        } else if queued > 0 && stalled > self.scaling.wait_threshold {
+            stalled
+        } else {
+            return None;
+        };
+
+        self.size
+            .fetch_update(Ordering::Relaxed, Ordering::Relaxed, |size| {
+                (size < self.scaling.max.get()).then_some(size + 1)
+            })
+            .ok()
+            .map(|size| {
+                // The new worker gets the time to pop the stalled jobs.
+                self.record_progress();
+                self.emit(ScalingEvent::Grown {
+                    size: size + 1,
+                    waiting_time,
+                });
+
+                waiting_time
+            })
+    }
+
+    /// Record that the worker `id` is respawned after a panic.
+    pub fn record_respawn(&self, id: usize) {
+        self.emit(ScalingEvent::Respawned { id });
+    }
+
+    /// Cancel a growth, if the worker cannot be spawned.
+    pub fn cancel_growth(&self) {
+        self.size.fetch_sub(1, Ordering::Relaxed);
+    }
+
+    /// Try to retire an idle worker, if the pool has more workers than its minimum.
+    ///
+    /// # Returns
+    ///
+    /// Returns `true` if the worker must end.
+    pub fn try_retire(&self) -> bool {
+        self.size
+            .fetch_update(Ordering::Relaxed, Ordering::Relaxed, |size| {
+                (size > self.scaling.min.get()).then(|| size - 1)
+            })
+            .map(|size| self.emit(ScalingEvent::Shrunk { size: size - 1 }))
+            .is_ok()
+    }
+
+    /// Send the `event`, or drop it if nobody reads the events.
+    #[doc(hidden)]
+    fn emit(&self, event: ScalingEvent) {
+        let _ = self.events.try_send(event);
+    }
+
+    /// Get the nanoseconds since the creation of the state.
+    #[doc(hidden)]
+    fn elapsed_nanos(&self) -> u64 {
+        Self::nanos(self.origin.elapsed())
+    }
+
+    /// Convert the `duration` in nanoseconds, saturated to [`u64::MAX`].
+    #[doc(hidden)]
+    fn nanos(duration: Duration) -> u64 {
+        u64::try_from(duration.as_nanos()).unwrap_or(u64::MAX)
+    }
+}
@@ -0,0 +1,169 @@
+use std::num::NonZeroUsize;
+use std::time::{Duration, Instant};
+
+use crate::requests::Job;
+
+use super::queue::{BoundedQueue, PushError};
+use super::stealing::StealingQueues;
+
+/// The strategy of the [`WorkerPool`][WorkerPool] to give the jobs to its workers.
+///
+/// # How to use it?
+///
+/// ```rust
+/// use std::num::NonZeroUsize;
+///
+/// use crate::threads::{Placement, Scaling, Scheduler, WorkerPool};
+///
+/// let scaling = Scaling::fixed(NonZeroUsize::new(4).unwrap());
+///
+/// // All workers pop the jobs of one shared queue.
+/// let shared = WorkerPool::builder(scaling).scheduler(Scheduler::Shared).build();
+///
+/// // Each worker pops the jobs of its own queue, and steals the jobs of its peers.
+/// let stealing = WorkerPool::builder(scaling)
+///     .scheduler(Scheduler::WorkStealing(Placement::LeastLoaded))
+///     .build();
+/// ```
+///
+/// <!-- References -->
+///
+/// [WorkerPool]: super::pool::WorkerPool
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum Scheduler {
+    /// All workers pop the jobs of one shared queue.
+    #[default]
+    Shared,
+
+    /// Each worker owns a local queue, and steals the jobs of its peers when it
+    /// is idle. The [`Placement`] chooses the queue of the new jobs.
+    WorkStealing(Placement),
+}
+
+/// The choice of the local queue of a new job, for [`Scheduler::WorkStealing`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum Placement {
+    /// The jobs are pushed into the local queues one after the other.
+    #[default]
+    RoundRobin,
+
+    /// The jobs are pushed into the shortest local queue, preferably the one of an
+    /// idle worker.
+    LeastLoaded,
+}
+
+/// The queues of the jobs of a [`WorkerPool`][WorkerPool], created from the
+/// [`Scheduler`].
+///
+/// <!-- References -->
+///
+/// [WorkerPool]: super::pool::WorkerPool
+#[derive(Debug)]
+pub enum JobQueues {
+    /// One queue shared by all workers.
+    Shared(BoundedQueue<Job>),
+
+    /// One local queue per worker.
+    Stealing(StealingQueues<Job>),
+}
+
+impl JobQueues {
+    /// Create the queues for the `scheduler`.
+    ///
+    /// # Parameters
+    ///
+    /// - `scheduler`: The strategy to give the jobs to the workers.
+    /// - `workers`: The maximal amount of workers.
+    /// - `capacity`: The maximal amount of waiting jobs.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`JobQueues`].
+    pub fn new(scheduler: Scheduler, workers: NonZeroUsize, capacity: NonZeroUsize) -> JobQueues {
+        match scheduler {
+            Scheduler::Shared => Self::Shared(BoundedQueue::new(capacity)),
+            Scheduler::WorkStealing(placement) => {
+                Self::Stealing(StealingQueues::new(workers, capacity, placement))
+            }
+        }
+    }
+
+    /// Push the `job`, and wake up a worker.
+    ///
+    /// # Returns
+    ///
+    /// Returns nothing if the job is pushed, or [`PushError`] with the `job` if the
+    /// queues are full or closed.
+    pub fn push(&self, job: Job) -> Result<(), PushError<Job>> {
+        match self {
+            Self::Shared(queue) => queue.push(job),
+            Self::Stealing(queues) => queues.push(job),
+        }
+    }
+
+    /// Indicate that the `worker` runs, so the jobs can be placed into its local
+    /// queue.
+    pub fn attach(&self, worker: usize) {
+        if let Self::Stealing(queues) = self {
+            queues.attach(worker);
+        }
+    }
+
+    /// Indicate that the `worker` ended, so no job is placed into its local queue
+    /// anymore.
+    pub fn detach(&self, worker: usize) {
+        if let Self::Stealing(queues) = self {
+            queues.detach(worker);
+        }
+    }
+
+    /// Pop the next job of the `worker`, and wait if there is no job.
+    ///
+    /// # Parameters
+    ///
+    /// - `worker`: The ID of the worker.
+    /// - `timeout`: The maximal duration to wait a job, or [`None`] to wait until
+    /// the queues are closed.
+    /// - `spin_until`: The end of the busy polling before parking the worker, or
+    /// [`None`] for a short spin.
+    ///
+    /// # Returns
+    ///
+    /// Returns the job, or [`None`] if the queues are closed and empty, or if the
+    /// `timeout` elapses.
+    pub fn pop_wait(
+        &self,
+        worker: usize,
+        timeout: Option<Duration>,
+        spin_until: Option<Instant>,
+    ) -> Option<Job> {
+        match self {
+            Self::Shared(queue) => queue.pop_wait(timeout, spin_until),
+            Self::Stealing(queues) => queues.pop_wait(worker, timeout, spin_until),
+        }
+    }
+
+    /// Get the approximate amount of waiting jobs.
+    pub fn len(&self) -> usize {
+        match self {
+            Self::Shared(queue) => queue.len(),
+            Self::Stealing(queues) => queues.len(),
+        }
+    }
+
+    /// Indicate if the queues are closed.
+    pub fn is_closed(&self) -> bool {
+        match self {
+            Self::Shared(queue) => queue.is_closed(),
+            Self::Stealing(queues) => queues.is_closed(),
+        }
+    }
+
+    /// Close the queues, the workers end after the execution of the remaining jobs.
+    pub fn close(&self) {
+        match self {
+            Self::Shared(queue) => queue.close(),
+            Self::Stealing(queues) => queues.close(),
+        }
+    }
+}
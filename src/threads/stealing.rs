@@ -0,0 +1,225 @@
+use std::num::NonZeroUsize;
+use std::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
+use std::time::{Duration, Instant};
+
+use super::queue::{BoundedQueue, PushError};
+use super::scheduler::Placement;
+
+/// The local queues of the workers, for the work-stealing scheduler.
+///
+/// Each worker pops the jobs of its own queue. When its queue is empty, the
+/// worker steals the jobs of its peers before being parked on its own queue.
+/// So, the workers never compete on one shared queue.
+///
+/// The jobs are pushed into a queue chosen with the [`Placement`], among the
+/// queues of the live workers: an elastic pool creates the queues of all its
+/// possible workers, but only runs some of them. If the worker of this queue is
+/// busy, an idle worker is woken up to steal the job.
+///
+/// # How to use it?
+///
+/// ```rust
+/// // Logic in the pool in `src/threads/pool.rs`.
+///
+/// use std::num::NonZeroUsize;
+///
+/// use crate::threads::scheduler::Placement;
+/// use crate::threads::stealing::StealingQueues;
+///
+/// let queues = StealingQueues::new(
+///     NonZeroUsize::new(4).unwrap(),
+///     NonZeroUsize::new(256).unwrap(),
+///     Placement::LeastLoaded,
+/// );
+/// for worker in 0..4 {
+///     queues.attach(worker);
+/// }
+///
+/// queues.push(42).unwrap();
+///
+/// // The worker 3 steals the value pushed into another queue.
+/// assert_eq!(queues.pop_wait(3, None, None), Some(42));
+/// ```
+#[derive(Debug)]
+pub struct StealingQueues<T> {
+    #[doc(hidden)]
+    queues: Box<[BoundedQueue<T>]>,
+    /// Indicate if the worker of each queue is running.
+    #[doc(hidden)]
+    live: Box<[AtomicBool]>,
+    #[doc(hidden)]
+    placement: Placement,
+    #[doc(hidden)]
+    next: AtomicUsize,
+}
+
+impl<T> StealingQueues<T> {
+    /// Create the local queues, without live worker.
+    ///
+    /// # Parameters
+    ///
+    /// - `workers`: The maximal amount of workers, so the amount of queues.
+    /// - `capacity`: The maximal amount of values in all queues, shared equally
+    /// between the queues.
+    /// - `placement`: The choice of the queue of pushed values.
+    ///
+    /// # Returns
+    ///
+    /// Returns a new instance of [`StealingQueues`].
+    pub fn new(
+        workers: NonZeroUsize,
+        capacity: NonZeroUsize,
+        placement: Placement,
+    ) -> StealingQueues<T> {
+        let local_capacity = NonZeroUsize::new(capacity.get().div_ceil(workers.get())).unwrap();
+
+        Self {
+            queues: (0..workers.get())
+                .map(|_| BoundedQueue::new(local_capacity))
+                .collect(),
+            live: (0..workers.get()).map(|_| AtomicBool::new(false)).collect(),
+            placement,
+            next: AtomicUsize::new(0),
+        }
+    }
+
+    /// Indicate that the `worker` runs, so values are pushed into its queue.
+    pub fn attach(&self, worker: usize) {
+        self.live[worker].store(true, Ordering::Release);
+    }
+
+    /// Indicate that the `worker` ended, so no value is pushed into its queue
+    /// anymore. The values left in its queue are stolen by its peers.
+    pub fn detach(&self, worker: usize) {
+        self.live[worker].store(false, Ordering::Release);
+
+        if !self.queues[worker].is_empty() {
+            self.unpark_thief(worker);
+        }
+    }
+
+    /// Push the `value` into the queue chosen by the [`Placement`].
+    ///
+    /// If the chosen queue is full, the queues of the other live workers are
+    /// tried, then the queues without worker, whose values are stolen. If the
+    /// worker of the queue is busy, a parked worker is woken up to steal the
+    /// value.
+    ///
+    /// # Returns
+    ///
+    /// Returns nothing if the value is pushed, or [`PushError`] with the `value`
+    /// if all queues are full, or if the queues are closed.
+    pub fn push(&self, value: T) -> Result<(), PushError<T>> {
+        let start = self.choose();
+        let mut value = value;
+
+        let count = self.queues.len();
+        let queues = |live: bool| {
+            (0..count)
+                .map(move |offset| (start + offset) % count)
+                .filter(move |index| self.is_live(*index) == live)
+        };
+
+        for index in queues(true).chain(queues(false)) {
+            match self.queues[index].push(value) {
+                Ok(()) => {
+                    if !self.queues[index].is_searched() {
+                        self.unpark_thief(index);
+                    }
+                    return Ok(());
+                }
+                Err(PushError::Full(rejected)) => value = rejected,
+                closed => return closed,
+            }
+        }
+
+        Err(PushError::Full(value))
+    }
+
+    /// Pop a value for the `worker`: from its queue, else stolen from the queues of
+    /// its peers. The worker is parked on its queue if all queues are empty.
+    ///
+    /// # Parameters
+    ///
+    /// - `worker`: The index of the queue of the worker.
+    /// - `timeout`: The maximal duration to wait a value, or [`None`] to wait
+    /// until the queues are closed.
+    /// - `spin_until`: The end of the busy polling before parking the worker, or
+    /// [`None`] for a short spin.
+    ///
+    /// # Returns
+    ///
+    /// Returns the value, or [`None`] if the queues are closed and empty, or if
+    /// the `timeout` elapses.
+    pub fn pop_wait(
+        &self,
+        worker: usize,
+        timeout: Option<Duration>,
+        spin_until: Option<Instant>,
+    ) -> Option<T> {
+        self.queues[worker].pop_wait_with(
+            || {
+                (0..self.queues.len())
+                    .map(|offset| (worker + offset) % self.queues.len())
+                    .find_map(|index| self.queues[index].pop())
+            },
+            timeout,
+            spin_until,
+        )
+    }
+
+    /// Get the approximate amount of values in all queues.
+    pub fn len(&self) -> usize {
+        self.queues.iter().map(|queue| queue.len()).sum()
+    }
+
+    /// Indicate if the queues are closed.
+    pub fn is_closed(&self) -> bool {
+        self.queues.iter().all(|queue| queue.is_closed())
+    }
+
+    /// Close all queues, the workers end after the pop of the remaining values.
+    pub fn close(&self) {
+        for queue in self.queues.iter() {
+            queue.close();
+        }
+    }
+
+    /// Indicate if the worker of the queue `index` runs.
+    #[doc(hidden)]
+    fn is_live(&self, index: usize) -> bool {
+        self.live[index].load(Ordering::Acquire)
+    }
+
+    /// Choose the index of the queue of the next pushed value, among the queues
+    /// of the live workers.
+    ///
+    /// # Returns
+    ///
+    /// Returns the chosen index, or the next index if no worker is live.
+    #[doc(hidden)]
+    fn choose(&self) -> usize {
+        let start = self.next.fetch_add(1, Ordering::Relaxed) % self.queues.len();
+        let mut live = (0..self.queues.len())
+            .map(|offset| (start + offset) % self.queues.len())
+            .filter(|index| self.is_live(*index));
+
+        match self.placement {
+            Placement::RoundRobin => live.next(),
+            Placement::LeastLoaded => live.min_by_key(|index| {
+                let queue = &self.queues[*index];
+                (queue.len(), !queue.has_idle_consumer())
+            }),
+        }
+        .unwrap_or(start)
+    }
+
+    /// Wake up a worker parked on another queue than `index`, to steal the value
+    /// pushed into the queue `index`.
+    #[doc(hidden)]
+    fn unpark_thief(&self, index: usize) {
+        (1..self.queues.len())
+            .map(|offset| (index + offset) % self.queues.len())
+            .any(|thief| self.queues[thief].unpark());
+    }
+}
@@ -1,10 +1,14 @@
 use std::any::Any;
 use std::fmt::{Display, Formatter};
-use std::sync::mpsc::Receiver;
-use std::sync::{Arc, Mutex};
+use std::sync::Arc;
 use std::thread::{Builder, JoinHandle};
 
-use crate::requests::Job;
+use crate::logging::{debug, error, info, trace, warning};
+use crate::requests::Response;
+
+use super::affinity::pin_current_thread;
+use super::scaling::PoolState;
+use super::scheduler::JobQueues;
 
 /// Abstraction layer around a [`JoinHandle`].
 ///
@@ -20,15 +24,29 @@ use crate::requests::Job;
 /// ```rust
 /// // Logic in the pool in `src/threads/pool.rs`.
 ///
-/// use std::sync::{Arc, Mutex};
-/// use std::sync::mpsc::channel;
+/// use std::num::NonZeroUsize;
+/// use std::sync::mpsc::sync_channel;
+/// use std::sync::Arc;
 ///
+/// use crate::threads::scaling::{PoolState, Scaling};
+/// use crate::threads::scheduler::{JobQueues, Scheduler};
 /// use crate::threads::worker::Worker;
 ///
-/// let (tx, rx) = channel();
-/// let rx = Arc::new(Mutex::new(rx));
-///
-/// let worker = Worker::new(0, Arc::clone(&rx));
+/// let queues = Arc::new(JobQueues::new(
+///     Scheduler::Shared,
+///     NonZeroUsize::new(1).unwrap(),
+///     NonZeroUsize::new(64).unwrap(),
+/// ));
+/// let (events, _) = sync_channel(1);
+/// let state = Arc::new(PoolState::new(
+///     Scaling::fixed(NonZeroUsize::new(1).unwrap()),
+///     events,
+///     None,
+///     None,
+///     None,
+/// ));
+///
+/// let worker = Worker::new(0, Arc::clone(&queues), Arc::clone(&state));
 /// // Now, the worker waits a job.
 /// ```
 ///
@@ -36,24 +54,38 @@ use crate::requests::Job;
 ///
 /// # How to stop it?
 ///
-/// To stop the worker execution, just drop the emitter/sender (tx) of the
-/// [`std::sync::mpsc::channel()`], like `drop(tx)`.
+/// To stop the worker execution, just close the [`JobQueues`], like
+/// `queues.close()`. The worker ends after the execution of the remaining jobs.
 ///
 /// ```rust
 /// // Logic in the pool in `src/threads/pool.rs`.
 ///
-/// use std::sync::{Arc, Mutex};
-/// use std::sync::mpsc::channel;
+/// use std::num::NonZeroUsize;
+/// use std::sync::mpsc::sync_channel;
+/// use std::sync::Arc;
 ///
+/// use crate::threads::scaling::{PoolState, Scaling};
+/// use crate::threads::scheduler::{JobQueues, Scheduler};
 /// use crate::threads::worker::Worker;
 ///
-/// let (tx, rx) = channel();
-/// let rx = Arc::new(Mutex::new(rx));
-///
-/// let worker = Worker::new(0, Arc::clone(&rx));
+/// let queues = Arc::new(JobQueues::new(
+///     Scheduler::Shared,
+///     NonZeroUsize::new(1).unwrap(),
+///     NonZeroUsize::new(64).unwrap(),
+/// ));
+/// let (events, _) = sync_channel(1);
+/// let state = Arc::new(PoolState::new(
+///     Scaling::fixed(NonZeroUsize::new(1).unwrap()),
+///     events,
+///     None,
+///     None,
+///     None,
+/// ));
+///
+/// let worker = Worker::new(0, Arc::clone(&queues), Arc::clone(&state));
 ///
 /// // To stop the worker
-/// drop(tx);
+/// queues.close();
 /// worker.join().unwrap();
 /// ```
 ///
@@ -72,14 +104,27 @@ pub struct Worker {
 }
 
 impl Worker {
-    /// Create a new worker with the ID and the receiver part of the
-    /// [`std::sync::mpsc::channel()`] aka `queue`.
+    /// Create a new worker with the ID and the `queues` of jobs.
+    ///
+    /// The worker records the waiting time of its jobs in the `state`. If the pool
+    /// is elastic, the worker retires after the idle cooldown without a job, if
+    /// the pool keeps its minimal amount of workers.
+    ///
+    /// A panic of a job is caught, so the worker keeps executing the next jobs.
+    ///
+    /// If the jobs wait too long in the queues, the `state` sheds the popped jobs,
+    /// which are rejected before the execution of their listener. The jobs whose
+    /// client left are dropped without their listener.
+    ///
+    /// If the `state` gives a CPU to the worker, the thread is pinned to it before
+    /// its first job, so its allocations come from the memory of its NUMA node.
     ///
     /// # Parameters
     ///
-    /// - `id`: ID given by the [`WorkerPool`][WorkerPool].
-    /// - `queue`: The receiver (rx) part of the channel created by the
-    /// [`WorkerPool`][WorkerPool].
+    /// - `id`: ID given by the [`WorkerPool`][WorkerPool], it is also the index of
+    /// its local queue with the work-stealing scheduler.
+    /// - `queues`: The [`JobQueues`] created by the [`WorkerPool`][WorkerPool].
+    /// - `state`: The [`PoolState`] shared by the workers of the pool.
     ///
     /// # Returns
     ///
@@ -92,25 +137,77 @@ impl Worker {
     /// <!-- References -->
     ///
     /// [WorkerPool]: super::pool::WorkerPool
-    pub fn new(id: usize, queue: Arc<Mutex<Receiver<Job>>>) -> Worker {
+    pub fn new(id: usize, queues: Arc<JobQueues>, state: Arc<PoolState>) -> Worker {
         Self {
             handle: Builder::new()
                 .name(format!("Worker - {id}"))
-                .spawn(move || loop {
-                    let job = queue.lock().unwrap().recv();
-
-                    if let Ok(job) = job {
-                        println!("Worker {id} got a job; executing.");
-                        job.execute().send();
-                    } else {
-                        println!("Worker {id} disconnected; shutting down.");
-                        break;
+                .spawn(move || {
+                    if let Some(cpu) = state.cpu_of(id) {
+                        if let Err(error) = pin_current_thread(cpu) {
+                            warning!(worker = id, cpu = cpu; "Worker not pinned: {error}.");
+                        }
                     }
+
+                    Self::run(id, &queues, &state);
                 })
                 .unwrap(),
         }
     }
 
+    /// Execute the jobs, until the queues are closed or the worker retires.
+    ///
+    /// The worker is attached to its local queue during its execution, cf.
+    /// [`JobQueues::attach()`].
+    #[doc(hidden)]
+    fn run(id: usize, queues: &JobQueues, state: &PoolState) {
+        queues.attach(id);
+
+        loop {
+            match queues.pop_wait(id, state.idle_timeout(), state.spin_deadline()) {
+                Some(job) if state.should_shed(job.waiting_time()) => {
+                    state.record_pop(job.waiting_time());
+
+                    warning!(
+                        worker = id, waited_ms = job.waiting_time().as_millis();
+                        "Worker shed a job; it waited too long.",
+                    );
+                    let _ = Response::reject_unavailable(job.request);
+                }
+                Some(job) if job.request.is_cancelled() => {
+                    state.record_pop(job.waiting_time());
+
+                    debug!(worker = id; "Worker skipped a job; its client left.");
+                }
+                Some(job) => {
+                    state.record_pop(job.waiting_time());
+
+                    trace!(worker = id; "Worker got a job; executing.");
+                    if job.run().is_err() {
+                        error!(worker = id; "Worker recovered from a panic of its job.");
+                    }
+                }
+                None if queues.is_closed() => {
+                    info!(worker = id; "Worker disconnected; shutting down.");
+                    break;
+                }
+                None => {
+                    if state.try_retire() {
+                        info!(worker = id; "Worker idle; retiring.");
+                        break;
+                    }
+                }
+            }
+        }
+
+        queues.detach(id);
+    }
+
+    /// Indicate if the thread ended its execution, so [`Worker::join()`] does not
+    /// wait.
+    pub fn is_finished(&self) -> bool {
+        self.handle.is_finished()
+    }
+
     /// Join the thread and wait until the thread ends its execution.
     ///
     /// # Returns